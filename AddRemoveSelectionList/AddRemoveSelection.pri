@@ -0,0 +1,21 @@
+# Sources of the AddRemoveSelection widget and its utilities. Included by the app and the benchmark.
+
+INCLUDEPATH += $$PWD
+
+include(Engine/SelectionEngine.pri)
+
+SOURCES += \
+    $$PWD/Widgets/AddRemoveSelection.cpp \
+    $$PWD/Widgets/AvailableListModel.cpp \
+    $$PWD/Widgets/SelectedListModel.cpp \
+    $$PWD/Widgets/SelectionCommands.cpp
+
+HEADERS += \
+    $$PWD/Widgets/AddRemoveSelection.h \
+    $$PWD/Widgets/AvailableListModel.h \
+    $$PWD/Widgets/SelectedListModel.h \
+    $$PWD/Widgets/ItemDataRole.h \
+    $$PWD/Widgets/SelectionCommands.h
+
+FORMS += \
+    $$PWD/Widgets/AddRemoveSelection.ui
@@ -26,14 +26,11 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 
+include(AddRemoveSelection.pri)
+
 SOURCES += main.cpp\
-        MainWindow.cpp \        
-    Widgets/AddRemoveSelection.cpp \
-    Util/ListCsvProcessor.cpp
+        MainWindow.cpp
 
-HEADERS  += MainWindow.h \        
-    Widgets/AddRemoveSelection.h \
-    Util/ListCsvProcessor.h
+HEADERS  += MainWindow.h
 
-FORMS    += MainWindow.ui \        
-    Widgets/AddRemoveSelection.ui
+FORMS    += MainWindow.ui
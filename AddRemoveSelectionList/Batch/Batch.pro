@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Command line batch tool which validates selection files against a catalog, remaps them and
+# writes them again, several files at a time:
+#   AddRemoveSelectionBatch --catalog <catalog.csv> [--output <dir>] [--threads <count>] <files>
+#
+#-------------------------------------------------
+
+QT       = core
+
+QMAKE_CXXFLAGS += -std=c++11
+CONFIG += c++11 console
+CONFIG -= debug_and_release app_bundle
+TARGET = AddRemoveSelectionBatch
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../Engine/SelectionEngine.pri)
+
+SOURCES += main.cpp \
+    SelectionBatch.cpp
+
+HEADERS += SelectionBatch.h
@@ -0,0 +1,130 @@
+#include "SelectionBatch.h"
+#include <Util/ListCsvProcessor.h>
+#include <Util/CatalogCsvReader.h>
+#include <Util/Trace.h>
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThreadPool>
+
+namespace
+{
+
+// Process one file of the batch into its slot of the results
+class SelectionBatchTask : public QRunnable {
+
+public:
+    SelectionBatchTask(const SelectionBatch *batch, const QString &filename, SelectionBatch::Result *result) :
+        _batch(batch), _filename(filename), _result(result) { ; }
+    void run() override { *_result = _batch->processFile(_filename); }
+
+private:
+    const SelectionBatch *_batch;
+    QString _filename;
+    SelectionBatch::Result *_result;
+};
+
+}
+
+SelectionBatch::SelectionBatch(const QStringList &fullList) :
+    _fullList(fullList) {
+    Util::TraceSpan span("SelectionBatch::SelectionBatch");
+    span.setItems(_fullList.size());
+    _fullListHash.reserve(_fullList.size());
+    _matchKeyHash.reserve(_fullList.size());
+    for (int idx = 0 ; idx < _fullList.size() ; ++idx) {
+        if (!_fullListHash.contains(_fullList.at(idx))) {
+            _fullListHash.insert(_fullList.at(idx), idx);
+        }
+        QString key = matchKey(_fullList.at(idx));
+        if (!_matchKeyHash.contains(key)) {
+            _matchKeyHash.insert(key, idx);
+        }
+    }
+}
+
+std::vector<SelectionBatch::Result> SelectionBatch::run(const QStringList &filenames) const {
+    Util::TraceSpan span("SelectionBatch::run");
+    span.setItems(filenames.size());
+    // Every task writes its own slot, so the vector must not be resized until they're done
+    std::vector<Result> results(unsigned(filenames.size()));
+    // The files which would write the same output file are rejected before any is written
+    QHash<QString, int> outputCount;
+    if (!_outputDir.isEmpty()) {
+        for (const QString &filename : filenames) {
+            ++outputCount[QFileInfo(filename).fileName()];
+        }
+    }
+    QThreadPool pool;
+    if (_maxThreadCount > 0) {
+        pool.setMaxThreadCount(_maxThreadCount);
+    }
+    for (int idx = 0 ; idx < filenames.size() ; ++idx) {
+        if (outputCount.value(QFileInfo(filenames.at(idx)).fileName()) > 1) {
+            results[unsigned(idx)].filename = filenames.at(idx);
+            results[unsigned(idx)].status = OutputClash;
+            continue;
+        }
+        pool.start(new SelectionBatchTask(this, filenames.at(idx), &results[unsigned(idx)]));
+    }
+    pool.waitForDone();
+    return results;
+}
+
+SelectionBatch::Result SelectionBatch::processFile(const QString &filename) const {
+    Util::TraceSpan span("SelectionBatch::processFile");
+    Result result;
+    result.filename = filename;
+    QStringList sList_raw, sList_alias;
+    result.status = Util::ListCsvProcessor::read(filename, sList_raw, sList_alias);
+    if (result.status != NoError) {
+        return result;
+    }
+    result.itemCount = sList_raw.size();
+    span.setItems(result.itemCount);
+    QStringList remapped_raw, remapped_alias;
+    remapped_raw.reserve(sList_raw.size());
+    remapped_alias.reserve(sList_alias.size());
+    for (int idx = 0 ; idx < sList_raw.size() ; ++idx) {
+        const int found = findName(sList_raw.at(idx));
+        if (found < 0) {
+            result.unmatched << sList_raw.at(idx);
+            continue;
+        }
+        const QString &name = _fullList.at(found);
+        result.remappedCount += (name != sList_raw.at(idx)) ? 1 : 0;
+        remapped_raw << name;
+        remapped_alias << sList_alias.at(idx);
+    }
+    result.matchedCount = remapped_raw.size();
+    if (_outputDir.isEmpty()) {
+        return result;
+    }
+    if (_validNameCheck) {
+        Util::NameSanitizer::sanitize(remapped_alias, _namingPolicy);
+    }
+    QString outputFile = QDir(_outputDir).filePath(QFileInfo(filename).fileName());
+    result.status = Util::ListCsvProcessor::write(outputFile, remapped_raw, remapped_alias);
+    return result;
+}
+
+// Only const functions of the indexes are used, so they're never detached and can be shared
+int SelectionBatch::findName(const QString &name) const {
+    auto found = _fullListHash.constFind(name);
+    if (found != _fullListHash.constEnd()) {
+        return found.value();
+    }
+    found = _matchKeyHash.constFind(matchKey(name));
+    return (found != _matchKeyHash.constEnd()) ? found.value() : -1;
+}
+
+int SelectionBatch::readCatalog(const QString &filename, QStringList &fullList) {
+    fullList.clear();
+    Util::CatalogCsvReader reader(filename);
+    // No event loop here: the chunks are delivered directly while run() reads the file
+    QObject::connect(&reader, &Util::CatalogCsvReader::chunkRead,
+                     [&fullList](const QStringList &names, const QStringList &, const QVector<unsigned int> &) {
+        fullList << names;
+    });
+    return reader.run();
+}
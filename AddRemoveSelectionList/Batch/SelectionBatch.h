@@ -0,0 +1,77 @@
+#ifndef SELECTIONBATCH_H
+#define SELECTIONBATCH_H
+
+#include <vector>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <Util/NameSanitizer.h>
+
+/*
+ * SelectionBatch applies selection files (CSV) to a catalog. Each file is read and validated
+ * with Util::ListCsvProcessor, and its names are remapped to the catalog entries: a name which
+ * isn't in the catalog as it's written is matched again ignoring the case and the spacing, and
+ * the catalog's own spelling is written. The items are written to the output directory under
+ * the same file name. The names which aren't in the catalog either way are dropped and
+ * reported. Two input files with the same file name would write the same output file, so they
+ * are both rejected.
+ *
+ * The catalog index is built once and only read afterwards, so the files are processed in
+ * parallel by a thread pool without any lock.
+*/
+class SelectionBatch {
+
+public:
+    // Status code of a file. Same as Util::ListCsvProcessor, and OutputClash when another input
+    // file has the same file name.
+    enum Status { NoError = 0, FileError = 1, FormatError = 2, OutputClash = 3 };
+
+    // Result of one selection file
+    struct Result {
+        QString filename;
+        int status = NoError;
+        // Number of items in the file, of the items found in the catalog, and of the found items
+        // whose name was changed to the catalog's spelling
+        int itemCount = 0;
+        int matchedCount = 0;
+        int remappedCount = 0;
+        // The names which aren't in the catalog, in the file order
+        QStringList unmatched;
+    };
+
+public:
+    // Index the names of the catalog. The first entry wins when a name appears more than once.
+    explicit SelectionBatch(const QStringList &fullList);
+    ~SelectionBatch() { ; }
+    // Write the remapped files to the directory. Without it the files are only checked.
+    void setOutputDir(const QString &dir) { _outputDir = dir; }
+    // Replace the characters not allowed by the naming policy in the aliases
+    void setValidNameCheck(bool state) { _validNameCheck = state; }
+    void setNamingPolicy(const Util::NamingPolicy &policy) { _namingPolicy = policy; }
+    // Maximum number of files processed at once, 0 for one per core
+    void setMaxThreadCount(int count) { _maxThreadCount = count; }
+    // Process the files and return their results, in the same order
+    std::vector<Result> run(const QStringList &filenames) const;
+    // Process a single file. It can be called from any thread.
+    Result processFile(const QString &filename) const;
+    // Return the catalog index of a name, or -1 when it isn't in the catalog
+    int findName(const QString &name) const;
+
+public: // Static
+    // Read the names of a catalog CSV file (name, tooltip, short list flag). Return a
+    // Util::CatalogCsvReader status.
+    static int readCatalog(const QString &filename, QStringList &fullList);
+    // Return the key a name is matched by when it isn't found as it's written
+    static QString matchKey(const QString &name) { return name.simplified().toCaseFolded(); }
+
+private:
+    QStringList _fullList;
+    QHash<QString, int> _fullListHash;
+    QHash<QString, int> _matchKeyHash;
+    QString _outputDir;
+    bool _validNameCheck = false;
+    Util::NamingPolicy _namingPolicy;
+    int _maxThreadCount = 0;
+};
+
+#endif // SELECTIONBATCH_H
@@ -0,0 +1,83 @@
+#include "SelectionBatch.h"
+#include <Util/Trace.h>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Validate selection files against a catalog, remap their names to the catalog's "
+                                     "spelling (ignoring the case and the spacing), drop the names which aren't in it "
+                                     "and write the files again. The files are processed in parallel.");
+    parser.addHelpOption();
+    QCommandLineOption catalogOption("catalog", "Catalog CSV file (name, tooltip, short list flag).", "file");
+    QCommandLineOption outputOption("output", "Write the remapped files to the directory, under their own file name. "
+                                              "Input files with the same file name are rejected. "
+                                              "Without it the files are only checked.", "dir");
+    QCommandLineOption threadsOption("threads", "Number of files processed at once (default one per core).", "count", "0");
+    QCommandLineOption checkNamesOption("check-names", "Replace the characters not allowed in the aliases by '_'.");
+    QCommandLineOption traceOption("trace", "Write a Chrome trace of the run to the file.", "file");
+    parser.addOption(catalogOption);
+    parser.addOption(outputOption);
+    parser.addOption(threadsOption);
+    parser.addOption(checkNamesOption);
+    parser.addOption(traceOption);
+    parser.addPositionalArgument("files", "Selection CSV files.", "<files...>");
+    parser.process(a);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (!parser.isSet(catalogOption) || parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+    if (parser.isSet(outputOption) && !QDir().mkpath(parser.value(outputOption))) {
+        err << "Can't create the output directory " << parser.value(outputOption) << endl;
+        return 1;
+    }
+    if (parser.isSet(traceOption)) {
+        Util::Trace::start(parser.value(traceOption));
+    }
+
+    QStringList fullList;
+    if (SelectionBatch::readCatalog(parser.value(catalogOption), fullList) != SelectionBatch::NoError) {
+        err << "Can't read the catalog " << parser.value(catalogOption) << endl;
+        return 1;
+    }
+    SelectionBatch batch(fullList);
+    batch.setOutputDir(parser.value(outputOption));
+    batch.setValidNameCheck(parser.isSet(checkNamesOption));
+    batch.setMaxThreadCount(parser.value(threadsOption).toInt());
+    std::vector<SelectionBatch::Result> results = batch.run(parser.positionalArguments());
+    Util::Trace::stop();
+
+    // One line per file, followed by its unmatched names
+    int failed = 0;
+    int unmatched = 0;
+    for (const SelectionBatch::Result &result : results) {
+        switch (result.status) {
+        case SelectionBatch::NoError:
+            out << result.filename << ": " << result.matchedCount << "/" << result.itemCount << " matched, "
+                << result.remappedCount << " remapped" << endl;
+            break;
+        case SelectionBatch::OutputClash:
+            out << result.filename << ": another file has the same file name" << endl;
+            break;
+        case SelectionBatch::FormatError:
+            out << result.filename << ": format error" << endl;
+            break;
+        default:
+            out << result.filename << ": file error" << endl;
+            break;
+        }
+        for (const QString &name : result.unmatched) {
+            out << "  unmatched: " << name << endl;
+        }
+        failed += (result.status != SelectionBatch::NoError) ? 1 : 0;
+        unmatched += result.unmatched.size();
+    }
+    out << results.size() << " files, " << failed << " failed, " << unmatched << " unmatched names" << endl;
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Headless benchmark of the AddRemoveSelection widget.
+# It runs on the offscreen platform plugin and prints the timings as JSON:
+#   AddRemoveSelectionBenchmark [--max <catalog size>] [--output <file>]
+#
+#-------------------------------------------------
+
+QT       += core gui widgets
+
+QMAKE_CXXFLAGS += -std=c++11
+CONFIG += c++11 console
+CONFIG -= debug_and_release app_bundle
+TARGET = AddRemoveSelectionBenchmark
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../AddRemoveSelection.pri)
+
+SOURCES += main.cpp \
+    SelectionBenchmark.cpp
+
+HEADERS += SelectionBenchmark.h
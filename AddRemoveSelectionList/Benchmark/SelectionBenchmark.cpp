@@ -0,0 +1,147 @@
+#include "SelectionBenchmark.h"
+#include <Widgets/AddRemoveSelection.h>
+#include <Util/ListCsvProcessor.h>
+#include <QCoreApplication>
+#include <QListView>
+#include <QPushButton>
+#include <QGuiApplication>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <algorithm>
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+SelectionBenchmark::SelectionBenchmark(const QString &workDir) : _workDir(workDir) {
+
+}
+
+void SelectionBenchmark::run(int size) {
+    Widgets::AddRemoveSelection widget;
+    widget.setValidNameCheck(true);
+    widget.show();
+    QCoreApplication::processEvents();
+    QStringList fullList = syntheticCatalog(size);
+    QStringList tooltips;
+    tooltips.reserve(size);
+    for (int idx = 0 ; idx < size ; ++idx) {
+        tooltips << QString("Synthetic signal %1").arg(idx);
+    }
+    QListView *availableView = widget.findChild<QListView*>("_availableListView");
+    QListView *selectedView = widget.findChild<QListView*>("_selectedListView");
+    QAbstractItemModel &available = *availableView->model();
+    QAbstractItemModel &selected = *selectedView->model();
+
+    measure(size, "setFullList", size, [&]() { widget.setFullList(fullList, tooltips); });
+    measure(size, "fetchMore", size, [&]() {
+        while (available.canFetchMore(QModelIndex())) {
+            available.fetchMore(QModelIndex());
+        }
+    });
+    // Blocks of 8 rows out of every 16, so both lists change in many runs
+    QItemSelection scattered;
+    for (int row = 0 ; row < available.rowCount() ; row += 16) {
+        scattered.select(available.index(row, 0), available.index(std::min(row + 7, available.rowCount() - 1), 0));
+    }
+    int nScattered = 0;
+    for (const QItemSelectionRange &range : scattered) {
+        nScattered += range.height();
+    }
+    availableView->selectionModel()->select(scattered, QItemSelectionModel::ClearAndSelect);
+    measure(size, "addItems.scattered", nScattered, [&]() { click(widget, "_addItemButton"); });
+    measure(size, "undo.addItems", nScattered, [&]() { widget.undoStack()->undo(); });
+    measure(size, "redo.addItems", nScattered, [&]() { widget.undoStack()->redo(); });
+    const int nRest = available.rowCount();
+    QItemSelection rest(available.index(0, 0), available.index(nRest - 1, 0));
+    availableView->selectionModel()->select(rest, QItemSelectionModel::ClearAndSelect);
+    measure(size, "addItems.contiguous", nRest, [&]() { click(widget, "_addItemButton"); });
+    // Move a block from the top of the selected list to the bottom, the same reorder as a drop
+    const int nMoved = std::min(1000, selected.rowCount() / 2);
+    measure(size, "reorder", nMoved, [&]() { selected.moveRows(QModelIndex(), 0, nMoved, QModelIndex(), selected.rowCount()); });
+    measure(size, "undo.reorder", nMoved, [&]() { widget.undoStack()->undo(); });
+    // CSV
+    const QString csvFile = _workDir + QString("/selection_%1.csv").arg(size);
+    const int nSelected = selected.rowCount();
+    measure(size, "ListCsvProcessor::write", nSelected, [&]() {
+        Util::ListCsvProcessor::write(csvFile, widget.getSelectedItemsList(true), widget.getSelectedItemsList(false));
+    });
+    measure(size, "ListCsvProcessor::read", nSelected, [&]() {
+        QStringList sList_raw, sList_alias;
+        Util::ListCsvProcessor::read(csvFile, sList_raw, sList_alias);
+    });
+    // Remove every other block of the selected list, then everything
+    QItemSelection scatteredSelected;
+    for (int row = 0 ; row < selected.rowCount() ; row += 16) {
+        scatteredSelected.select(selected.index(row, 0), selected.index(std::min(row + 7, selected.rowCount() - 1), 0));
+    }
+    int nRemoved = 0;
+    for (const QItemSelectionRange &range : scatteredSelected) {
+        nRemoved += range.height();
+    }
+    selectedView->selectionModel()->select(scatteredSelected, QItemSelectionModel::ClearAndSelect);
+    measure(size, "removeItems.scattered", nRemoved, [&]() { click(widget, "_removeItemButton"); });
+    measure(size, "undo.removeItems", nRemoved, [&]() { widget.undoStack()->undo(); });
+    measure(size, "reset", nSelected, [&]() { click(widget, "_reset"); });
+    measure(size, "readListFromFile.csv", nSelected, [&]() { widget.readListFromFile(csvFile); });
+    // Snapshot
+    const QString snapshotFile = _workDir + QString("/selection_%1.arss").arg(size);
+    measure(size, "saveSnapshot", nSelected, [&]() { widget.engine().saveSnapshotToFile(snapshotFile); });
+    measure(size, "readListFromFile.snapshot", nSelected, [&]() { widget.readListFromFile(snapshotFile); });
+}
+
+QJsonDocument SelectionBenchmark::results() const {
+    QJsonObject root;
+    root.insert("platform", QGuiApplication::platformName());
+    root.insert("results", _results);
+    root.insert("peakRssKb", double(peakRssKb()));
+    return QJsonDocument(root);
+}
+
+void SelectionBenchmark::measure(int size, const QString &operation, int itemCount, const std::function<void()> &function) {
+    QElapsedTimer timer;
+    timer.start();
+    function();
+    QCoreApplication::processEvents();
+    const qint64 elapsed = timer.nsecsElapsed();
+    QJsonObject result;
+    result.insert("size", size);
+    result.insert("operation", operation);
+    result.insert("items", itemCount);
+    result.insert("ms", double(elapsed) / 1.0e6);
+    result.insert("peakRssKb", double(peakRssKb()));
+    _results.append(result);
+}
+
+void SelectionBenchmark::click(Widgets::AddRemoveSelection &widget, const QString &buttonName) {
+    widget.findChild<QPushButton*>(buttonName)->click();
+}
+
+QStringList SelectionBenchmark::syntheticCatalog(int size) {
+    QStringList fullList;
+    fullList.reserve(size);
+    for (int idx = 0 ; idx < size ; ++idx) {
+        if (idx % 4 == 0) { // Needs to be sanitized
+            fullList << QString("group %1.signal-%2").arg(idx / 100).arg(idx % 100);
+        }
+        else {
+            fullList << QString("group_%1_signal_%2").arg(idx / 100).arg(idx % 100);
+        }
+    }
+    return fullList;
+}
+
+long SelectionBenchmark::peakRssKb() {
+#if defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#if defined(Q_OS_MACOS)
+    return long(usage.ru_maxrss / 1024); // Bytes on macOS
+#else
+    return long(usage.ru_maxrss);
+#endif
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,46 @@
+#ifndef SELECTIONBENCHMARK_H
+#define SELECTIONBENCHMARK_H
+
+#include <functional>
+#include <QString>
+#include <QStringList>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace Widgets {
+class AddRemoveSelection;
+}
+
+/*
+ * SelectionBenchmark drives an AddRemoveSelection widget through the same code paths as the
+ * user does: add / remove by selection, undo / redo, reorder, reset, and loading / saving the
+ * selected list. It only goes through the public API and the child widgets: the rows are
+ * selected in the list views and the buttons are clicked, and a reorder is a moveRows() on the
+ * selected model, which is what a drop does. Every operation is timed including the events it
+ * posts, and the peak resident set size is recorded after it.
+*/
+class SelectionBenchmark {
+
+public:
+    explicit SelectionBenchmark(const QString &workDir);
+    // Run all the operations on a synthetic catalog of the size
+    void run(int size);
+    // Return the results
+    QJsonDocument results() const;
+
+private:
+    // Time a function in milliseconds, including the events it posts
+    void measure(int size, const QString &operation, int itemCount, const std::function<void()> &function);
+    // Click a button of the widget by its object name
+    static void click(Widgets::AddRemoveSelection &widget, const QString &buttonName);
+    // Return a catalog with some names that need to be sanitized
+    static QStringList syntheticCatalog(int size);
+    // Return the peak resident set size in KB, -1 if unknown
+    static long peakRssKb();
+
+private:
+    QString _workDir;
+    QJsonArray _results;
+};
+
+#endif // SELECTIONBENCHMARK_H
@@ -0,0 +1,54 @@
+#include "SelectionBenchmark.h"
+#include <Util/Trace.h>
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    // Headless unless another platform is asked for
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication a(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark of the AddRemoveSelection widget on synthetic catalogs from 10^3 entries up to the maximum size.");
+    parser.addHelpOption();
+    QCommandLineOption maxOption("max", "Largest catalog size (default 1000000).", "size", "1000000");
+    QCommandLineOption outputOption("output", "Write the JSON results to the file instead of the standard output.", "file");
+    QCommandLineOption traceOption("trace", "Write a Chrome trace of the run to the file.", "file");
+    parser.addOption(maxOption);
+    parser.addOption(outputOption);
+    parser.addOption(traceOption);
+    parser.process(a);
+    if (parser.isSet(traceOption)) {
+        Util::Trace::start(parser.value(traceOption));
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        return 1;
+    }
+    SelectionBenchmark benchmark(workDir.path());
+    const int maxSize = parser.value(maxOption).toInt();
+    for (int size = 1000 ; size <= maxSize ; size *= 10) {
+        benchmark.run(size);
+        if (size > maxSize / 10) {
+            break;
+        }
+    }
+    Util::Trace::stop();
+    QByteArray json = benchmark.results().toJson();
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            return 1;
+        }
+    }
+    else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# SelectionEngine as a static library for batch jobs and services.
+# It only links QtCore: no QtWidgets, no event loop, no items.
+#
+#-------------------------------------------------
+
+QT       = core
+
+QMAKE_CXXFLAGS += -std=c++11
+CONFIG += c++11 staticlib
+CONFIG -= debug_and_release
+TARGET = SelectionEngine
+TEMPLATE = lib
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(SelectionEngine.pri)
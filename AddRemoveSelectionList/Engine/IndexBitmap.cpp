@@ -0,0 +1,134 @@
+#include "IndexBitmap.h"
+#include <algorithm>
+
+namespace Engine
+{
+
+namespace
+{
+
+// Number of bits set in a word
+inline unsigned int popCount(quint64 word) {
+#if defined(__GNUC__)
+    return unsigned(__builtin_popcountll(word));
+#else
+    unsigned int count = 0;
+    for ( ; word ; word &= word - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Position of the lowest bit set in a word, which isn't 0
+inline unsigned int lowestBit(quint64 word) {
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctzll(word));
+#else
+    unsigned int pos = 0;
+    for ( ; !(word & 1) ; word >>= 1) {
+        pos++;
+    }
+    return pos;
+#endif
+}
+
+// Append the positions of the bits set in a word, offset by base
+inline void appendBits(quint64 word, unsigned int base, std::vector<unsigned int> &index) {
+    for ( ; word ; word &= word - 1) {
+        index.push_back(base + lowestBit(word));
+    }
+}
+
+}
+
+IndexBitmap::IndexBitmap(unsigned int size, bool value) :
+    _words((size + 63) / 64, value ? ~quint64(0) : quint64(0)), _size(size) {
+    // The bits past the size are always cleared
+    if (value && (size & 63)) {
+        _words.back() = (quint64(1) << (size & 63)) - 1;
+    }
+}
+
+void IndexBitmap::resize(unsigned int size) {
+    if (size < _size && (size & 63)) {
+        _words[size >> 6] &= (quint64(1) << (size & 63)) - 1;
+    }
+    _words.resize((size + 63) / 64, 0);
+    _size = size;
+}
+
+void IndexBitmap::set(unsigned int idx) {
+    if (idx >= _size) {
+        resize(idx + 1);
+    }
+    _words[idx >> 6] |= quint64(1) << (idx & 63);
+}
+
+void IndexBitmap::reset(unsigned int idx) {
+    if (idx < _size) {
+        _words[idx >> 6] &= ~(quint64(1) << (idx & 63));
+    }
+}
+
+void IndexBitmap::resetRange(unsigned int first, unsigned int last) {
+    if (_size == 0 || first > last || first >= _size) {
+        return;
+    }
+    last = std::min(last, _size - 1);
+    const unsigned int firstWord = first >> 6;
+    const unsigned int lastWord = last >> 6;
+    // Masks of the bits from first to the end of its word, and from the start of the last word
+    const quint64 firstMask = ~quint64(0) << (first & 63);
+    const quint64 lastMask = ~quint64(0) >> (63 - (last & 63));
+    if (firstWord == lastWord) {
+        _words[firstWord] &= ~(firstMask & lastMask);
+        return;
+    }
+    _words[firstWord] &= ~firstMask;
+    std::fill(_words.begin() + firstWord + 1, _words.begin() + lastWord, quint64(0));
+    _words[lastWord] &= ~lastMask;
+}
+
+void IndexBitmap::andNotWords(unsigned int firstWord, const quint64 *words, unsigned int count) {
+    for (unsigned int pos = 0 ; pos < count && firstWord + pos < _words.size() ; ++pos) {
+        _words[firstWord + pos] &= ~words[pos];
+    }
+}
+
+unsigned int IndexBitmap::count() const {
+    unsigned int count = 0;
+    for (const quint64 &word : _words) {
+        count += popCount(word);
+    }
+    return count;
+}
+
+IndexBitmap &IndexBitmap::operator&=(const IndexBitmap &other) {
+    for (unsigned int pos = 0 ; pos < _words.size() ; ++pos) {
+        _words[pos] &= (pos < other._words.size()) ? other._words[pos] : 0;
+    }
+    return *this;
+}
+
+std::vector<unsigned int> IndexBitmap::toIndex() const {
+    std::vector<unsigned int> index;
+    for (unsigned int pos = 0 ; pos < _words.size() ; ++pos) {
+        appendBits(_words[pos], pos * 64, index);
+    }
+    return index;
+}
+
+std::vector<unsigned int> IndexBitmap::andNot(const IndexBitmap &other) const {
+    std::vector<unsigned int> index;
+    for (unsigned int pos = 0 ; pos < _words.size() ; ++pos) {
+        quint64 word = _words[pos];
+        if (pos < other._words.size()) {
+            word &= ~other._words[pos];
+        }
+        appendBits(word, pos * 64, index);
+    }
+    return index;
+}
+
+}
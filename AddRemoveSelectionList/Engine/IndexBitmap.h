@@ -0,0 +1,50 @@
+#ifndef INDEXBITMAP_H
+#define INDEXBITMAP_H
+
+#include <vector>
+#include <QtGlobal>
+
+namespace Engine
+{
+
+/*
+ * IndexBitmap is a set of full list indexes, one bit per index of the full list. Set operations
+ * work on 64 indexes at a time, and the indexes of a set are listed by skipping the empty words,
+ * so listing costs the size of the full list / 64 on top of the indexes found.
+*/
+class IndexBitmap {
+
+public:
+    IndexBitmap() { ; }
+    // A bitmap of size indexes, all set or all cleared
+    explicit IndexBitmap(unsigned int size, bool value = false);
+    // Return the number of indexes the bitmap covers
+    unsigned int size() const { return _size; }
+    // Cover size indexes. The new indexes are cleared.
+    void resize(unsigned int size);
+    // Set / clear an index. Setting an index out of the bitmap extends it.
+    void set(unsigned int idx);
+    void reset(unsigned int idx);
+    // Clear the indexes [first, last]
+    void resetRange(unsigned int first, unsigned int last);
+    // Clear the bits set in words, which start at the word firstWord of the bitmap
+    void andNotWords(unsigned int firstWord, const quint64 *words, unsigned int count);
+    // Return true if the index is set. An index out of the bitmap is not set.
+    bool test(unsigned int idx) const { return idx < _size && ((_words[idx >> 6] >> (idx & 63)) & 1); }
+    // Return the number of indexes set
+    unsigned int count() const;
+    // Keep only the indexes which are also set in other
+    IndexBitmap &operator&=(const IndexBitmap &other);
+    // Return the indexes set, in ascending order
+    std::vector<unsigned int> toIndex() const;
+    // Return the indexes set here and not in other, in ascending order
+    std::vector<unsigned int> andNot(const IndexBitmap &other) const;
+
+private:
+    std::vector<quint64> _words;
+    unsigned int _size = 0;
+};
+
+}
+
+#endif // INDEXBITMAP_H
@@ -0,0 +1,277 @@
+#include "IndexSet.h"
+#include <algorithm>
+
+namespace Engine
+{
+
+namespace
+{
+
+const unsigned int ChunkWords = 1024;
+// Size in bytes of the containers, to choose the smallest
+const unsigned int BitmapBytes = ChunkWords * 8;
+
+// Position of the lowest bit set in a word, which isn't 0
+inline unsigned int lowestBit(quint64 word) {
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctzll(word));
+#else
+    unsigned int pos = 0;
+    for ( ; !(word & 1) ; word >>= 1) {
+        pos++;
+    }
+    return pos;
+#endif
+}
+
+}
+
+const unsigned int IndexSet::MaxArraySize;
+
+bool IndexSet::contains(unsigned int idx) const {
+    const unsigned int key = idx >> 16;
+    if (key >= _chunks.size()) {
+        return false;
+    }
+    const Container &chunk = _chunks[key];
+    const quint16 low = quint16(idx & 0xFFFF);
+    switch (chunk.type) {
+    case BitmapContainer:
+        return (chunk.words[low >> 6] >> (low & 63)) & 1;
+    case ArrayContainer:
+        return std::binary_search(chunk.values.begin(), chunk.values.end(), low);
+    case RunContainer: {
+        // The last run starting at or before the low bits
+        size_t first = 0;
+        size_t last = chunk.values.size() / 2;
+        while (first < last) {
+            const size_t middle = (first + last) / 2;
+            if (chunk.values[middle * 2] <= low) {
+                first = middle + 1;
+            }
+            else {
+                last = middle;
+            }
+        }
+        return first > 0 && unsigned(low - chunk.values[(first - 1) * 2]) <= chunk.values[(first - 1) * 2 + 1];
+    }
+    }
+    return false;
+}
+
+bool IndexSet::insert(unsigned int idx) {
+    const unsigned int key = idx >> 16;
+    if (key >= _chunks.size()) {
+        _chunks.resize(key + 1);
+    }
+    Container &chunk = _chunks[key];
+    const quint16 low = quint16(idx & 0xFFFF);
+    if (chunk.type == RunContainer) {
+        unpackRuns(chunk);
+    }
+    if (chunk.type == BitmapContainer) {
+        quint64 &word = chunk.words[low >> 6];
+        const quint64 bit = quint64(1) << (low & 63);
+        if (word & bit) {
+            return false;
+        }
+        word |= bit;
+    }
+    else {
+        auto pos = std::lower_bound(chunk.values.begin(), chunk.values.end(), low);
+        if (pos != chunk.values.end() && *pos == low) {
+            return false;
+        }
+        chunk.values.insert(pos, low);
+    }
+    ++chunk.count;
+    ++_size;
+    if (chunk.type == ArrayContainer && chunk.count > MaxArraySize) {
+        toBitmap(chunk);
+    }
+    return true;
+}
+
+bool IndexSet::remove(unsigned int idx) {
+    const unsigned int key = idx >> 16;
+    if (key >= _chunks.size()) {
+        return false;
+    }
+    Container &chunk = _chunks[key];
+    const quint16 low = quint16(idx & 0xFFFF);
+    if (chunk.type == RunContainer) {
+        unpackRuns(chunk);
+    }
+    if (chunk.type == BitmapContainer) {
+        quint64 &word = chunk.words[low >> 6];
+        const quint64 bit = quint64(1) << (low & 63);
+        if (!(word & bit)) {
+            return false;
+        }
+        word &= ~bit;
+    }
+    else {
+        auto pos = std::lower_bound(chunk.values.begin(), chunk.values.end(), low);
+        if (pos == chunk.values.end() || *pos != low) {
+            return false;
+        }
+        chunk.values.erase(pos);
+    }
+    --chunk.count;
+    --_size;
+    if (chunk.type == BitmapContainer && chunk.count <= MaxArraySize) {
+        toArray(chunk);
+    }
+    trim();
+    return true;
+}
+
+void IndexSet::clear() {
+    _chunks.clear();
+    _size = 0;
+}
+
+void IndexSet::assign(const std::vector<unsigned int> &sortedIndex) {
+    clear();
+    std::vector<quint16> low;
+    for (size_t pos = 0 ; pos < sortedIndex.size() ; ) {
+        const unsigned int key = sortedIndex[pos] >> 16;
+        low.clear();
+        for ( ; pos < sortedIndex.size() && (sortedIndex[pos] >> 16) == key ; ++pos) {
+            low.push_back(quint16(sortedIndex[pos] & 0xFFFF));
+        }
+        _chunks.resize(key + 1);
+        pack(_chunks[key], low);
+        _size += _chunks[key].count;
+    }
+}
+
+void IndexSet::optimize() {
+    for (Container &chunk : _chunks) {
+        if (chunk.count > 0) {
+            pack(chunk, lowBits(chunk));
+        }
+    }
+}
+
+std::vector<unsigned int> IndexSet::toIndex() const {
+    std::vector<unsigned int> index;
+    index.reserve(_size);
+    for (unsigned int key = 0 ; key < _chunks.size() ; ++key) {
+        for (const quint16 &low : lowBits(_chunks[key])) {
+            index.push_back((key << 16) | low);
+        }
+    }
+    return index;
+}
+
+void IndexSet::clearFrom(IndexBitmap &bits) const {
+    for (unsigned int key = 0 ; key < _chunks.size() ; ++key) {
+        const Container &chunk = _chunks[key];
+        const unsigned int base = key << 16;
+        switch (chunk.type) {
+        case BitmapContainer:
+            bits.andNotWords(base / 64, chunk.words.data(), ChunkWords);
+            break;
+        case ArrayContainer:
+            for (const quint16 &low : chunk.values) {
+                bits.reset(base + low);
+            }
+            break;
+        case RunContainer:
+            for (size_t run = 0 ; run < chunk.values.size() ; run += 2) {
+                bits.resetRange(base + chunk.values[run], base + chunk.values[run] + chunk.values[run + 1]);
+            }
+            break;
+        }
+    }
+}
+
+std::vector<quint16> IndexSet::lowBits(const Container &container) {
+    std::vector<quint16> low;
+    low.reserve(container.count);
+    switch (container.type) {
+    case ArrayContainer:
+        low = container.values;
+        break;
+    case BitmapContainer:
+        for (unsigned int pos = 0 ; pos < ChunkWords ; ++pos) {
+            for (quint64 word = container.words[pos] ; word ; word &= word - 1) {
+                low.push_back(quint16(pos * 64 + lowestBit(word)));
+            }
+        }
+        break;
+    case RunContainer:
+        for (size_t run = 0 ; run < container.values.size() ; run += 2) {
+            for (unsigned int value = container.values[run] ; value <= unsigned(container.values[run]) + container.values[run + 1] ; ++value) {
+                low.push_back(quint16(value));
+            }
+        }
+        break;
+    }
+    return low;
+}
+
+void IndexSet::pack(Container &container, const std::vector<quint16> &low) {
+    std::vector<quint16> runs;
+    for (const quint16 &value : low) {
+        if (!runs.empty() && unsigned(runs[runs.size() - 2]) + runs.back() + 1 == value) {
+            runs.back()++;
+        }
+        else {
+            runs.push_back(value);
+            runs.push_back(0);
+        }
+    }
+    container.count = unsigned(low.size());
+    container.values.clear();
+    container.words.clear();
+    const unsigned int arrayBytes = unsigned(low.size()) * 2;
+    const unsigned int runBytes = 2 + unsigned(runs.size()) * 2;
+    if (runBytes < std::min(arrayBytes, BitmapBytes)) {
+        container.type = RunContainer;
+        container.values.swap(runs);
+    }
+    else if (low.size() <= MaxArraySize) {
+        container.type = ArrayContainer;
+        container.values = low;
+    }
+    else {
+        container.type = ArrayContainer;
+        container.values = low;
+        toBitmap(container);
+    }
+    container.values.shrink_to_fit();
+}
+
+void IndexSet::unpackRuns(Container &container) {
+    std::vector<quint16> low = lowBits(container);
+    container.type = ArrayContainer;
+    container.values.swap(low);
+    if (container.count > MaxArraySize) {
+        toBitmap(container);
+    }
+}
+
+void IndexSet::toBitmap(Container &container) {
+    container.words.assign(ChunkWords, 0);
+    for (const quint16 &low : container.values) {
+        container.words[low >> 6] |= quint64(1) << (low & 63);
+    }
+    container.type = BitmapContainer;
+    std::vector<quint16>().swap(container.values);
+}
+
+void IndexSet::toArray(Container &container) {
+    container.values = lowBits(container);
+    container.type = ArrayContainer;
+    std::vector<quint64>().swap(container.words);
+}
+
+void IndexSet::trim() {
+    while (!_chunks.empty() && _chunks.back().count == 0) {
+        _chunks.pop_back();
+    }
+}
+
+}
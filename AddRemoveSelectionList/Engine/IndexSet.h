@@ -0,0 +1,81 @@
+#ifndef INDEXSET_H
+#define INDEXSET_H
+
+#include <vector>
+#include <QtGlobal>
+#include "IndexBitmap.h"
+
+namespace Engine
+{
+
+/*
+ * IndexSet is a compressed set of full list indexes in the style of a roaring bitmap. The
+ * indexes are split by their high 16 bits into chunks of 65536, and each chunk is kept in one of
+ * three containers: a sorted array of the low 16 bits (up to MaxArraySize indexes), a bitmap of
+ * 1024 words, or runs of consecutive indexes. The chunks are found by their high bits directly,
+ * so a lookup is a bit test in a bitmap, or a binary search of at most MaxArraySize values or
+ * runs. Sparse chunks stay small, full ones cost 8 KiB, and long ranges a few bytes per range.
+ *
+ * Insertions and removals switch a chunk between an array and a bitmap as it grows or shrinks.
+ * Runs are only made by assign() and optimize(), a chunk of runs which is changed is unpacked
+ * first.
+*/
+class IndexSet {
+
+public:
+    // A chunk with more indexes than this is a bitmap instead of an array
+    static const unsigned int MaxArraySize = 4096;
+
+public:
+    IndexSet() { ; }
+    // Return the number of indexes
+    unsigned int size() const { return _size; }
+    bool isEmpty() const { return _size == 0; }
+    // Return true if the index is in the set
+    bool contains(unsigned int idx) const;
+    // Add / remove an index. Return false if it was already in / not in the set.
+    bool insert(unsigned int idx);
+    bool remove(unsigned int idx);
+    // Remove all the indexes
+    void clear();
+    // Replace the set with indexes (sorted, without duplicates), each chunk in its smallest container
+    void assign(const std::vector<unsigned int> &sortedIndex);
+    // Put each chunk in its smallest container
+    void optimize();
+    // Return the indexes, in ascending order
+    std::vector<unsigned int> toIndex() const;
+    // Clear the indexes of the set in a bitmap, a word or a run at a time when it can
+    void clearFrom(IndexBitmap &bits) const;
+
+private:
+    enum ContainerType { ArrayContainer = 0, BitmapContainer = 1, RunContainer = 2 };
+    struct Container {
+        ContainerType type = ArrayContainer;
+        // Number of indexes in the chunk
+        unsigned int count = 0;
+        // Array: the sorted low bits. Runs: (first low bits, length - 1) pairs, sorted.
+        std::vector<quint16> values;
+        // Bitmap: 1024 words
+        std::vector<quint64> words;
+    };
+    // Return the low bits of a chunk, sorted
+    static std::vector<quint16> lowBits(const Container &container);
+    // Fill a chunk from its sorted low bits in the smallest container
+    static void pack(Container &container, const std::vector<quint16> &low);
+    // Change a chunk of runs into an array or a bitmap, so it can be changed
+    static void unpackRuns(Container &container);
+    // Change an array into a bitmap / a bitmap into an array
+    static void toBitmap(Container &container);
+    static void toArray(Container &container);
+    // Drop the empty chunks at the end
+    void trim();
+
+private:
+    // The chunks by their high bits
+    std::vector<Container> _chunks;
+    unsigned int _size = 0;
+};
+
+}
+
+#endif // INDEXSET_H
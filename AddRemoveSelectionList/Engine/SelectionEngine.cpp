@@ -0,0 +1,746 @@
+#include "SelectionEngine.h"
+#include <algorithm>
+#include <Util/ListCsvProcessor.h>
+#include <Util/ListCsvWriter.h>
+#include <Util/ListFileLoader.h>
+#include <Util/Trace.h>
+
+namespace Engine
+{
+
+SelectionEngine::SelectionEngine() {
+
+}
+
+void SelectionEngine::addObserver(SelectionObserver *observer) {
+    if (observer && std::find(_observers.begin(), _observers.end(), observer) == _observers.end()) {
+        _observers.push_back(observer);
+    }
+}
+
+void SelectionEngine::removeObserver(SelectionObserver *observer) {
+    _observers.erase(std::remove(_observers.begin(), _observers.end(), observer), _observers.end());
+}
+
+void SelectionEngine::setFullList(const QStringList &fullList, const QStringList &tooltipList) {
+    setCatalog(Util::Catalog(fullList, tooltipList));
+}
+
+void SelectionEngine::setFullList(const QStringList &fullList, const QStringList &tooltipList, const std::vector<unsigned int> &listIndex) {
+    setCatalog(Util::Catalog(fullList, tooltipList), listIndex);
+}
+
+void SelectionEngine::setCatalog(const Util::Catalog &catalog) {
+    _catalog = catalog;
+    _fullListFingerprintValid = false;
+    _shortListIndex.clear();
+    _shortListBits = IndexBitmap();
+    rebuildViews();
+    notify([](SelectionObserver *observer) { observer->availableListReset(); });
+}
+
+void SelectionEngine::setCatalog(const Util::Catalog &catalog, const std::vector<unsigned int> &listIndex) {
+    _catalog = catalog;
+    _fullListFingerprintValid = false;
+    rebuildViews();
+    setShortListIndex(listIndex);
+}
+
+void SelectionEngine::appendFullList(const QStringList &fullList, const QStringList &tooltipList, const std::vector<unsigned int> &listIndex) {
+    Util::TraceSpan span("SelectionEngine::appendFullList");
+    span.setItems(fullList.size());
+    const unsigned int nOld = unsigned(_catalog.size());
+    // The tooltips are kept only if they still cover the whole full list
+    _catalog.append(fullList, tooltipList);
+    _fullListFingerprintValid = false;
+    // The short list index of the chunk goes after the existing one
+    std::vector<unsigned int> chunkShortIndex;
+    for (const unsigned int &idx : listIndex) {
+        if (idx >= nOld && idx < unsigned(_catalog.size())) {
+            chunkShortIndex.push_back(idx);
+        }
+    }
+    std::sort(chunkShortIndex.begin(), chunkShortIndex.end());
+    chunkShortIndex.erase(std::unique(chunkShortIndex.begin(), chunkShortIndex.end()), chunkShortIndex.end());
+    _shortListIndex.insert(_shortListIndex.end(), chunkShortIndex.begin(), chunkShortIndex.end());
+    for (const unsigned int &idx : chunkShortIndex) {
+        _shortListBits.set(idx);
+    }
+    const bool wasNarrowed = (_currentView >= 0);
+    if (addTooltipViews(nOld)) {
+        notify([](SelectionObserver *observer) { observer->availableViewsChanged(); });
+    }
+    // Switch to the short list once there is one
+    bool wasFullList = isFullList();
+    if (!_shortListEnabled && !_shortListIndex.empty() && _shortListIndex.size() != unsigned(_catalog.size())) {
+        _shortListEnabled = true;
+        _fullListShown = false;
+    }
+    // The current view is gone if the tooltip views were removed
+    if (isFullList() != wasFullList || wasNarrowed != (_currentView >= 0)) {
+        notify([](SelectionObserver *observer) { observer->availableListChanged(); });
+    }
+    else { // None of the new items can be selected yet
+        std::vector<unsigned int> chunkIndex;
+        for (unsigned int idx = nOld ; idx < unsigned(_catalog.size()) ; ++idx) {
+            if (isShown(idx)) {
+                chunkIndex.push_back(idx);
+            }
+        }
+        notify([&](SelectionObserver *observer) { observer->availableIndexesAppended(chunkIndex); });
+    }
+}
+
+/*
+ * The old entries are matched to the new ones by name (Util::Catalog::indexIn()). The selected
+ * items which are gone are removed as rows, the other ones only get their new index. As long
+ * as the entries which are kept stay in the same order, the available list is updated in place:
+ * the entries which are gone are removed, the rest is renumbered, and the difference left
+ * (new entries, short list or view changes) is a plain available list change. Otherwise the
+ * available list is rebuilt, the selection is kept all the same.
+*/
+void SelectionEngine::reloadFullList(const QStringList &fullList, const QStringList &tooltipList, const std::vector<unsigned int> &listIndex) {
+    Util::TraceSpan span("SelectionEngine::reloadFullList");
+    span.setItems(fullList.size());
+    Util::Catalog catalog(fullList, tooltipList);
+    const std::vector<int> newIndex = _catalog.indexIn(catalog);
+    bool inOrder = true;
+    int lastIndex = -1;
+    for (const int &idx : newIndex) {
+        if (idx >= 0) {
+            inOrder = inOrder && (idx > lastIndex);
+            lastIndex = idx;
+        }
+    }
+    // The selected items which are gone, as runs of rows
+    std::vector<std::pair<int,int>> goneRuns;
+    int row = 0;
+    _selected.forEach([&](const SelectionSequence::Item &item) {
+        if (item.index >= newIndex.size() || newIndex.at(item.index) < 0) {
+            if (!goneRuns.empty() && goneRuns.back().second + 1 == row) {
+                goneRuns.back().second = row;
+            }
+            else {
+                goneRuns.push_back(std::make_pair(row, row));
+            }
+        }
+        ++row;
+    });
+    for (auto run = goneRuns.rbegin() ; run != goneRuns.rend() ; ++run) {
+        const int first = run->first;
+        const int last = run->second;
+        notify([&](SelectionObserver *observer) { observer->selectedItemsAboutToBeRemoved(first, last); });
+        for (const SelectionSequence::Item &item : _selected.take(unsigned(first), unsigned(last))) {
+            uncountAlias(item.alias);
+        }
+        notify([&](SelectionObserver *observer) { observer->selectedItemsRemoved(first, last); });
+    }
+    if (inOrder) { // Removed while they still refer to the current full list
+        std::vector<unsigned int> goneIndex;
+        for (const unsigned int &idx : availableIndex()) {
+            if (newIndex.at(idx) < 0) {
+                goneIndex.push_back(idx);
+            }
+        }
+        notify([&](SelectionObserver *observer) { observer->availableIndexesRemoved(goneIndex); });
+    }
+    _catalog = catalog;
+    _fullListFingerprintValid = false;
+    // Renumber the selection. The items are rebuilt as a whole, rows don't change.
+    std::vector<SelectionSequence::Item> items;
+    items.reserve(_selected.size());
+    _selected.forEach([&](const SelectionSequence::Item &item) {
+        items.push_back(item);
+        items.back().index = unsigned(newIndex.at(item.index));
+    });
+    _selected.assign(items);
+    rebuildSelectedSet();
+    // The short list is the one of the new file, the full / short choice is kept
+    assignShortListIndex(listIndex);
+    if (!_shortListEnabled && !_shortListIndex.empty() && _shortListIndex.size() != unsigned(_catalog.size())) {
+        _shortListEnabled = true;
+        _fullListShown = false;
+    }
+    // The named views are renumbered and the tooltip views made again. The current view is
+    // kept by name.
+    const QString currentName = (_currentView >= 0) ? _views.at(unsigned(_currentView)).name : QString();
+    std::vector<View> views;
+    for (unsigned int view = 0 ; view < _views.size() ; ++view) {
+        if (std::find(_tooltipViews.begin(), _tooltipViews.end(), int(view)) != _tooltipViews.end()) {
+            continue;
+        }
+        View renumbered;
+        renumbered.name = _views.at(view).name;
+        renumbered.bits = IndexBitmap(unsigned(_catalog.size()));
+        for (const unsigned int &idx : _views.at(view).bits.toIndex()) {
+            if (idx < newIndex.size() && newIndex.at(idx) >= 0) {
+                renumbered.bits.set(unsigned(newIndex.at(idx)));
+            }
+        }
+        views.push_back(renumbered);
+    }
+    _views.swap(views);
+    _tooltipViews.clear();
+    _currentView = -1;
+    addTooltipViews(0);
+    for (unsigned int view = 0 ; view < _views.size() && !currentName.isNull() ; ++view) {
+        if (_views.at(view).name == currentName) {
+            _currentView = int(view);
+            break;
+        }
+    }
+    notify([](SelectionObserver *observer) { observer->availableViewsChanged(); });
+    if (inOrder) {
+        notify([&](SelectionObserver *observer) { observer->availableIndexesRenumbered(newIndex); });
+        notify([](SelectionObserver *observer) { observer->availableListChanged(); });
+    }
+    else {
+        notify([](SelectionObserver *observer) { observer->availableListReset(); });
+    }
+}
+
+void SelectionEngine::setTooltips(const QStringList &tooltipList) {
+    // If size doesn't match, remove the tooltips.
+    _catalog.setTooltips(tooltipList);
+    if (_viewsFromTooltips) {
+        rebuildViews();
+    }
+    notify([](SelectionObserver *observer) { observer->availableListReset(); });
+}
+
+void SelectionEngine::setShortListIndex(const std::vector<unsigned int> &listIndex) {
+    assignShortListIndex(listIndex);
+    // Switch to the short list if we do need to switch between lists
+    if ((_shortListIndex.size() != unsigned(_catalog.size())) && !_catalog.isEmpty()) {
+        _shortListEnabled = true;
+        _fullListShown = false;
+    }
+    notify([](SelectionObserver *observer) { observer->availableListReset(); });
+}
+
+void SelectionEngine::assignShortListIndex(const std::vector<unsigned int> &listIndex) {
+    _shortListIndex = listIndex;
+    // Remove duplicate elements and sort
+    std::sort(_shortListIndex.begin(), _shortListIndex.end());
+    _shortListIndex.erase(std::unique(_shortListIndex.begin(), _shortListIndex.end()), _shortListIndex.end());
+    // Remove out of bound index
+    _shortListIndex.erase(std::lower_bound(_shortListIndex.begin(), _shortListIndex.end(), unsigned(_catalog.size())),
+                          _shortListIndex.end());
+    _shortListBits = IndexBitmap(unsigned(_catalog.size()));
+    for (const unsigned int &idx : _shortListIndex) {
+        _shortListBits.set(idx);
+    }
+}
+
+void SelectionEngine::setFullListShown(bool shown) {
+    bool wasFullList = isFullList();
+    _fullListShown = shown;
+    if (isFullList() != wasFullList) {
+        notify([](SelectionObserver *observer) { observer->availableListChanged(); });
+    }
+}
+
+std::vector<unsigned int> SelectionEngine::availableIndex() const {
+    Util::TraceSpan span("SelectionEngine::availableIndex");
+    const unsigned int nFull = unsigned(_catalog.size());
+    // The shown items are the full list or the short list, narrowed to the current view
+    IndexBitmap shownBits = isFullList() ? IndexBitmap(nFull, true) : _shortListBits;
+    if (_currentView >= 0) {
+        shownBits &= _views.at(unsigned(_currentView)).bits;
+    }
+    _selectedSet.clearFrom(shownBits);
+    std::vector<unsigned int> unSelectedIndex = shownBits.toIndex();
+    span.setItems(qint64(unSelectedIndex.size()));
+    return unSelectedIndex;
+}
+
+quint64 SelectionEngine::fullListFingerprint() const {
+    if (!_fullListFingerprintValid) {
+        _fullListFingerprint = Util::ListSnapshotProcessor::fingerprint(_catalog);
+        _fullListFingerprintValid = true;
+    }
+    return _fullListFingerprint;
+}
+
+int SelectionEngine::addView(const QString &name, const std::vector<unsigned int> &index) {
+    View view;
+    view.name = name;
+    view.bits = IndexBitmap(unsigned(_catalog.size()));
+    for (const unsigned int &idx : index) {
+        if (idx < unsigned(_catalog.size())) {
+            view.bits.set(idx);
+        }
+    }
+    _views.push_back(view);
+    notify([](SelectionObserver *observer) { observer->availableViewsChanged(); });
+    return int(_views.size()) - 1;
+}
+
+void SelectionEngine::setViewsFromTooltips(bool enabled) {
+    if (enabled == _viewsFromTooltips) {
+        return;
+    }
+    _viewsFromTooltips = enabled;
+    if (!enabled) {
+        clearViews();
+    }
+    else if (addTooltipViews(0)) {
+        notify([](SelectionObserver *observer) { observer->availableViewsChanged(); });
+    }
+}
+
+void SelectionEngine::clearViews() {
+    if (_views.empty()) {
+        return;
+    }
+    const bool wasNarrowed = (_currentView >= 0);
+    _views.clear();
+    _tooltipViews.clear();
+    _currentView = -1;
+    notify([](SelectionObserver *observer) { observer->availableViewsChanged(); });
+    if (wasNarrowed) {
+        notify([](SelectionObserver *observer) { observer->availableListChanged(); });
+    }
+}
+
+QStringList SelectionEngine::viewNames() const {
+    QStringList names;
+    for (const View &view : _views) {
+        names << view.name;
+    }
+    return names;
+}
+
+void SelectionEngine::setCurrentView(int view) {
+    if (view < 0 || view >= viewCount()) {
+        view = -1;
+    }
+    if (view == _currentView) {
+        return;
+    }
+    _currentView = view;
+    notify([](SelectionObserver *observer) { observer->availableListChanged(); });
+}
+
+std::vector<unsigned int> SelectionEngine::selectedIndex() const {
+    std::vector<unsigned int> index;
+    index.reserve(_selected.size());
+    _selected.forEach([&index](const SelectionSequence::Item &item) { index.push_back(item.index); });
+    return index;
+}
+
+QStringList SelectionEngine::selectedRawList() const {
+    QStringList rawList;
+    rawList.reserve(int(_selected.size()));
+    _selected.forEach([&](const SelectionSequence::Item &item) {
+        if (item.index < unsigned(_catalog.size())) {
+            rawList << _catalog.name(int(item.index));
+        }
+    });
+    return rawList;
+}
+
+QStringList SelectionEngine::selectedAliasList() const {
+    QStringList aliasList;
+    aliasList.reserve(int(_selected.size()));
+    _selected.forEach([&aliasList](const SelectionSequence::Item &item) { aliasList << item.alias; });
+    return aliasList;
+}
+
+void SelectionEngine::insertItems(int row, const std::vector<unsigned int> &index, const QStringList &aliasList) {
+    Util::TraceSpan span("SelectionEngine::insertItems");
+    span.setItems(qint64(index.size()));
+    if (index.empty()) {
+        return;
+    }
+    const int last = row + int(index.size()) - 1;
+    std::vector<SelectionSequence::Item> items(index.size());
+    for (unsigned int pos = 0 ; pos < index.size() ; ++pos) {
+        items[pos].index = index.at(pos);
+        items[pos].alias = aliasList.at(int(pos));
+        countAlias(items[pos].alias);
+        selectIndex(items[pos].index);
+    }
+    notify([&](SelectionObserver *observer) { observer->selectedItemsAboutToBeInserted(row, last); });
+    _selected.insert(unsigned(row), items);
+    notify([&](SelectionObserver *observer) { observer->selectedItemsInserted(row, last); });
+    // Each contiguous block leaves the available list at once
+    std::vector<unsigned int> sortedIndex(index);
+    std::sort(sortedIndex.begin(), sortedIndex.end());
+    sortedIndex.erase(std::unique(sortedIndex.begin(), sortedIndex.end()), sortedIndex.end());
+    notify([&](SelectionObserver *observer) { observer->availableIndexesRemoved(sortedIndex); });
+}
+
+void SelectionEngine::appendItems(const std::vector<unsigned int> &index) {
+    insertItems(int(_selected.size()), index, defaultAliases(index));
+}
+
+void SelectionEngine::takeItems(const std::vector<std::pair<int,int>> &runs) {
+    Util::TraceSpan span("SelectionEngine::takeItems");
+    std::vector<unsigned int> returnedIndex;
+    for (const auto &run : runs) {
+        for (int row = run.first ; row <= run.second ; ++row) {
+            unsigned int fullIndex = selectedIndexAt(row);
+            // An item which isn't in the short list is not put back while the short list is shown
+            if (isShown(fullIndex)) {
+                returnedIndex.push_back(fullIndex);
+            }
+        }
+    }
+    span.setItems(qint64(returnedIndex.size()));
+    // An index which was selected more than once is put back once, and only if none of its
+    // selections is left
+    std::sort(returnedIndex.begin(), returnedIndex.end());
+    std::vector<unsigned int> freedIndex;
+    for (size_t pos = 0 ; pos < returnedIndex.size() ; ) {
+        size_t end = pos + 1;
+        while (end < returnedIndex.size() && returnedIndex.at(end) == returnedIndex.at(pos)) {
+            end++;
+        }
+        if (end - pos > _selectedRepeats.value(returnedIndex.at(pos))) {
+            freedIndex.push_back(returnedIndex.at(pos));
+        }
+        pos = end;
+    }
+    notify([&](SelectionObserver *observer) { observer->availableIndexesInserted(freedIndex); });
+    // Remove the runs from the highest order
+    for (auto run = runs.rbegin() ; run != runs.rend() ; ++run) {
+        const int first = run->first;
+        const int last = run->second;
+        notify([&](SelectionObserver *observer) { observer->selectedItemsAboutToBeRemoved(first, last); });
+        for (const SelectionSequence::Item &item : _selected.take(unsigned(first), unsigned(last))) {
+            uncountAlias(item.alias);
+            unselectIndex(item.index);
+        }
+        notify([&](SelectionObserver *observer) { observer->selectedItemsRemoved(first, last); });
+    }
+}
+
+/*
+ * The rows are split into blocks which are contiguous both before and after the move, and the
+ * blocks are moved one at a time in their order. The rows which don't move keep their order, so
+ * the place of a block is given by its gap: the number of the rows which don't move in front of
+ * it. A block goes right in front of the row which doesn't move at its target gap, behind the
+ * blocks already there. Since the blocks are moved in order, each one is still the first of its
+ * gap when it's moved, and its row is its gap plus the sizes of the blocks in the lower gaps.
+ * These sums are kept in a Fenwick tree over the gaps, so a move costs O(log N) and the
+ * observers get one move per block.
+*/
+void SelectionEngine::moveItems(const std::vector<int> &fromRows, const std::vector<int> &toRows) {
+    Util::TraceSpan span("SelectionEngine::moveItems");
+    span.setItems(qint64(fromRows.size()));
+    if (fromRows.empty() || fromRows.size() != toRows.size()) {
+        return;
+    }
+    struct Block {
+        int size;
+        int gap;
+        int targetGap;
+    };
+    std::vector<Block> blocks;
+    int nMoved = 0;
+    for (unsigned int begin = 0 ; begin < fromRows.size() ; ) {
+        unsigned int end = begin + 1;
+        while (end < fromRows.size() && fromRows.at(end - 1) + 1 == fromRows.at(end) && toRows.at(end - 1) + 1 == toRows.at(end)) {
+            end++;
+        }
+        Block block;
+        block.size = int(end - begin);
+        block.gap = fromRows.at(begin) - nMoved;
+        block.targetGap = toRows.at(begin) - nMoved;
+        blocks.push_back(block);
+        nMoved += block.size;
+        begin = end;
+    }
+    // Sizes of the blocks by gap. sizeUpTo(gap) is the number of rows of the blocks up to the gap.
+    std::vector<int> tree(_selected.size() - unsigned(nMoved) + 2, 0);
+    auto addSize = [&tree](int gap, int size) {
+        for (unsigned int pos = unsigned(gap) + 1 ; pos < tree.size() ; pos += pos & (~pos + 1)) {
+            tree[pos] += size;
+        }
+    };
+    auto sizeUpTo = [&tree](int gap) {
+        int size = 0;
+        for (unsigned int pos = unsigned(gap) + 1 ; pos > 0 ; pos -= pos & (~pos + 1)) {
+            size += tree[pos];
+        }
+        return size;
+    };
+    for (const Block &block : blocks) {
+        addSize(block.gap, block.size);
+    }
+    for (const Block &block : blocks) {
+        const int first = block.gap + ((block.gap > 0) ? sizeUpTo(block.gap - 1) : 0);
+        const int last = first + block.size - 1;
+        addSize(block.gap, -block.size);
+        // The row once the block is taken out
+        const int row = block.targetGap + sizeUpTo(block.targetGap);
+        addSize(block.targetGap, block.size);
+        if (row == first) {
+            continue;
+        }
+        const int destRow = (row > first) ? row + block.size : row;
+        notify([&](SelectionObserver *observer) { observer->selectedItemsAboutToBeMoved(first, last, destRow); });
+        _selected.move(unsigned(first), unsigned(last), unsigned(row));
+        notify([&](SelectionObserver *observer) { observer->selectedItemsMoved(first, last, destRow); });
+    }
+}
+
+void SelectionEngine::renameItem(int row, const QString &alias) {
+    QString &current = _selected.at(unsigned(row)).alias;
+    if (current == alias) {
+        return;
+    }
+    uncountAlias(current);
+    countAlias(alias);
+    current = alias;
+    notify([&](SelectionObserver *observer) { observer->selectedItemRenamed(row); });
+}
+
+void SelectionEngine::loadItems(const std::vector<unsigned int> &index, const QStringList &aliasList) {
+    Util::TraceSpan span("SelectionEngine::loadItems");
+    span.setItems(qint64(index.size()));
+    notify([](SelectionObserver *observer) { observer->selectedListAboutToBeReset(); });
+    const IndexSet previousSet = _selectedSet;
+    QStringList validList = aliasList;
+    if (_validNameCheck) { // Sanitize all the aliases at once
+        Util::NameSanitizer::sanitize(validList, _namingPolicy);
+    }
+    std::vector<SelectionSequence::Item> items(index.size());
+    _aliasCount.clear();
+    _aliasSuffix.clear();
+    for (unsigned int pos = 0 ; pos < index.size() ; ++pos) {
+        items[pos].index = index.at(pos);
+        items[pos].alias = validList.value(int(pos));
+        countAlias(items[pos].alias);
+    }
+    _selected.assign(items);
+    rebuildSelectedSet();
+    notify([](SelectionObserver *observer) { observer->selectedListReset(); });
+    // Only the items which came into or went out of the selection change in the available list,
+    // so it costs the two selections instead of the full list
+    std::vector<unsigned int> takenIndex;
+    for (const unsigned int &idx : _selectedSet.toIndex()) {
+        if (!previousSet.contains(idx) && isShown(idx)) {
+            takenIndex.push_back(idx);
+        }
+    }
+    std::vector<unsigned int> freedIndex;
+    for (const unsigned int &idx : previousSet.toIndex()) {
+        if (!_selectedSet.contains(idx) && isShown(idx)) {
+            freedIndex.push_back(idx);
+        }
+    }
+    notify([&](SelectionObserver *observer) { observer->availableIndexesRemoved(takenIndex); });
+    notify([&](SelectionObserver *observer) { observer->availableIndexesInserted(freedIndex); });
+}
+
+void SelectionEngine::loadItemsFromLists(const QStringList &sList_raw, const QStringList &sList_alias) {
+    // Names are resolved through a hash of the full list
+    Util::ListFileLoader loader(QString(), _catalog, fullListFingerprint());
+    loader.resolveNames(sList_raw, sList_alias);
+    loadItems(loader.index(), loader.aliasList());
+}
+
+QString SelectionEngine::defaultAlias(unsigned int fullIndex) const {
+    return validAlias(_catalog.name(int(fullIndex)));
+}
+
+QStringList SelectionEngine::defaultAliases(const std::vector<unsigned int> &index) const {
+    Util::TraceSpan span("SelectionEngine::defaultAliases");
+    span.setItems(qint64(index.size()));
+    QStringList aliasList;
+    aliasList.reserve(int(index.size()));
+    for (const unsigned int &idx : index) {
+        aliasList << _catalog.name(int(idx));
+    }
+    if (_validNameCheck) { // Sanitize all the aliases at once
+        Util::NameSanitizer::sanitize(aliasList, _namingPolicy);
+    }
+    return aliasList;
+}
+
+QString SelectionEngine::validAlias(const QString &alias) const {
+    QString validText = alias;
+    if (_validNameCheck) {
+        Util::NameSanitizer::sanitize(validText, _namingPolicy);
+    }
+    return validText;
+}
+
+QString SelectionEngine::uniqueAlias(const QString &alias) {
+    // Start from the suffix after the last one given to this name. A suffix which is freed later
+    // isn't reused, but the new name is still unique.
+    unsigned int idx = _aliasSuffix.value(alias, 1);
+    QString newAlias = alias;
+    while (_aliasCount.contains(newAlias)) {
+        newAlias = alias + QString("_%1").arg(idx);
+        idx++;
+    }
+    _aliasSuffix.insert(alias, idx);
+    return newAlias;
+}
+
+int SelectionEngine::readListFromFile(const QString &filename) {
+    Util::ListFileLoader loader(filename, _catalog, fullListFingerprint());
+    int status = loader.run();
+    if (status == Util::ListFileLoader::NoError) {
+        loadItems(loader.index(), loader.aliasList());
+    }
+    return status;
+}
+
+int SelectionEngine::saveListToFile(const QString &filename) const {
+    Util::TraceSpan span("SelectionEngine::saveListToFile");
+    span.setItems(_selected.size());
+    // The rows are streamed from the selection and the catalog, no list is built
+    Util::ListCsvWriter writer(filename);
+    if (!writer.open()) {
+        return Util::ListCsvProcessor::FileError;
+    }
+    _selected.forEach([&](const SelectionSequence::Item &item) {
+        if (item.index < unsigned(_catalog.size())) {
+            writer.writeRow(_catalog.nameRef(int(item.index)), QStringRef(&item.alias));
+        }
+    });
+    return writer.commit();
+}
+
+int SelectionEngine::saveSnapshotToFile(const QString &filename) const {
+    return Util::ListSnapshotProcessor::write(filename, snapshot());
+}
+
+Util::ListSnapshot SelectionEngine::snapshot() const {
+    Util::ListSnapshot snapshot;
+    snapshot.fingerprint = fullListFingerprint();
+    snapshot.fullListSize = unsigned(_catalog.size());
+    snapshot.index = selectedIndex();
+    snapshot.rawList = selectedRawList();
+    // Only keep the aliases which were renamed
+    unsigned int row = 0;
+    _selected.forEach([&](const SelectionSequence::Item &item) {
+        if (item.alias != defaultAlias(item.index)) {
+            snapshot.aliasList.push_back(std::make_pair(row, item.alias));
+        }
+        row++;
+    });
+    return snapshot;
+}
+
+bool SelectionEngine::isShown(unsigned int fullIndex) const {
+    if (_currentView >= 0 && !_views.at(unsigned(_currentView)).bits.test(fullIndex)) {
+        return false;
+    }
+    if (isFullList()) {
+        return fullIndex < unsigned(_catalog.size());
+    }
+    return _shortListBits.test(fullIndex);
+}
+
+/*
+ * Each view is a bitmap over the full list, so a tooltip column of free text (a distinct value
+ * for most entries) would cost a bitmap per entry. Past MaxTooltipViews distinct tooltips, the
+ * tooltips aren't taken for categories and their views are removed.
+*/
+bool SelectionEngine::addTooltipViews(unsigned int first) {
+    if (!_viewsFromTooltips || !_catalog.hasTooltips()) {
+        return false;
+    }
+    // The dictionary starts with the empty tooltip
+    if (_catalog.tooltipDictionary().size() - 1 > MaxTooltipViews) {
+        return removeTooltipViews();
+    }
+    bool added = false;
+    for (unsigned int idx = first ; idx < unsigned(_catalog.size()) ; ++idx) {
+        const int code = _catalog.tooltipCode(int(idx));
+        if (code == 0) { // No tooltip
+            continue;
+        }
+        if (unsigned(code) >= _tooltipViews.size()) {
+            _tooltipViews.resize(unsigned(code) + 1, -1);
+        }
+        int &view = _tooltipViews[unsigned(code)];
+        if (view < 0) {
+            View newView;
+            newView.name = _catalog.tooltipDictionary().at(code);
+            _views.push_back(newView);
+            view = int(_views.size()) - 1;
+            added = true;
+        }
+        _views[unsigned(view)].bits.set(idx);
+    }
+    return added;
+}
+
+bool SelectionEngine::removeTooltipViews() {
+    if (_tooltipViews.empty()) {
+        return false;
+    }
+    std::vector<View> views;
+    int currentView = -1;
+    for (unsigned int view = 0 ; view < _views.size() ; ++view) {
+        if (std::find(_tooltipViews.begin(), _tooltipViews.end(), int(view)) == _tooltipViews.end()) {
+            if (int(view) == _currentView) {
+                currentView = int(views.size());
+            }
+            views.push_back(_views.at(view));
+        }
+    }
+    _views.swap(views);
+    _tooltipViews.clear();
+    _currentView = currentView;
+    return true;
+}
+
+void SelectionEngine::rebuildViews() {
+    bool changed = !_views.empty();
+    _views.clear();
+    _tooltipViews.clear();
+    _currentView = -1;
+    changed = addTooltipViews(0) || changed;
+    if (changed) {
+        notify([](SelectionObserver *observer) { observer->availableViewsChanged(); });
+    }
+}
+
+void SelectionEngine::selectIndex(unsigned int fullIndex) {
+    if (!_selectedSet.insert(fullIndex)) {
+        ++_selectedRepeats[fullIndex];
+    }
+}
+
+void SelectionEngine::unselectIndex(unsigned int fullIndex) {
+    auto repeats = _selectedRepeats.find(fullIndex);
+    if (repeats == _selectedRepeats.end()) {
+        _selectedSet.remove(fullIndex);
+    }
+    else if (--repeats.value() == 0) {
+        _selectedRepeats.erase(repeats);
+    }
+}
+
+void SelectionEngine::rebuildSelectedSet() {
+    std::vector<unsigned int> index = selectedIndex();
+    std::sort(index.begin(), index.end());
+    _selectedRepeats.clear();
+    for (size_t pos = 1 ; pos < index.size() ; ++pos) {
+        if (index.at(pos) == index.at(pos - 1)) {
+            ++_selectedRepeats[index.at(pos)];
+        }
+    }
+    index.erase(std::unique(index.begin(), index.end()), index.end());
+    _selectedSet.assign(index);
+}
+
+void SelectionEngine::countAlias(const QString &alias) {
+    ++_aliasCount[alias];
+}
+
+void SelectionEngine::uncountAlias(const QString &alias) {
+    auto count = _aliasCount.find(alias);
+    if (count != _aliasCount.end() && --count.value() == 0) {
+        _aliasCount.erase(count);
+    }
+}
+
+}
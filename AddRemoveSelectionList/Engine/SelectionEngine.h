@@ -0,0 +1,233 @@
+#ifndef SELECTIONENGINE_H
+#define SELECTIONENGINE_H
+
+#include <vector>
+#include <utility>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <Util/NameSanitizer.h>
+#include <Util/ListSnapshotProcessor.h>
+#include <Util/Catalog.h>
+#include "SelectionObserver.h"
+#include "SelectionSequence.h"
+#include "IndexBitmap.h"
+#include "IndexSet.h"
+
+namespace Engine
+{
+
+/*
+ * SelectionEngine holds the state of a selection out of a catalog (the full list), without
+ * any UI: the full list and its tooltips, the short list, the selected items as full list
+ * indexes with their aliases, and the alias bookkeeping. The available list is everything
+ * which is shown (the full or the short list, narrowed to the current view if any) and not
+ * selected, in the full list order. Views are named subsets of the full list such as the
+ * categories in the tooltips. The short list and the views are bitmaps over the full list, so
+ * the available list is a bitmap AND-NOT of the selection. The selected indexes are also kept as
+ * a compressed IndexSet, for the membership tests and the AND-NOT.
+ * It only depends on QtCore, so it can be used by batch jobs without QtWidgets or an event
+ * loop. Views follow the changes through SelectionObserver.
+ *
+ * Rows are the positions in the selected list. Runs are [first, last] pairs of rows, sorted
+ * and not overlapping. The selected list is a SelectionSequence, so a row is found in O(log N)
+ * and blocks of rows are inserted, removed and moved without shifting the rows behind them.
+*/
+class SelectionEngine {
+
+public:
+    SelectionEngine();
+    ~SelectionEngine() { ; }
+
+    // Observers are notified in the order they were added. They must outlive the engine or be
+    // removed before they are destroyed.
+    void addObserver(SelectionObserver *observer);
+    void removeObserver(SelectionObserver *observer);
+
+public: // Catalog
+    // Set a new full list with its associated tooltip list (same size, otherwise ignored)
+    void setFullList(const QStringList &fullList, const QStringList &tooltipList = QStringList());
+    // Same as above, and provide an index for a shorter list
+    void setFullList(const QStringList &fullList, const QStringList &tooltipList, const std::vector<unsigned int> &listIndex);
+    // Use a catalog as the full list. The catalog is implicitly shared, so engines set with the
+    // same catalog hold a single copy of the names and tooltips. An engine which changes its
+    // catalog afterwards (append, tooltips) gets its own copy.
+    void setCatalog(const Util::Catalog &catalog);
+    // Same as above, and provide an index for a shorter list
+    void setCatalog(const Util::Catalog &catalog, const std::vector<unsigned int> &listIndex);
+    // Append a chunk to the end of the full list. The list index is the index of the whole
+    // full list for the items of the chunk which are in the short list.
+    void appendFullList(const QStringList &fullList, const QStringList &tooltipList, const std::vector<unsigned int> &listIndex);
+    // Replace the full list with a new version of it, e.g. the catalog file changed. The entries
+    // are matched by name: the selected items keep their rows and aliases, those which are gone
+    // are removed. The views only get the row updates when the kept entries are in the same order.
+    void reloadFullList(const QStringList &fullList, const QStringList &tooltipList, const std::vector<unsigned int> &listIndex);
+    // Set the tooltip list. The size of tooltip list is the same as the full list.
+    void setTooltips(const QStringList &tooltipList);
+    // Initialize the short list with the index range of the full list. Duplicate and out of
+    // range indexes are dropped.
+    void setShortListIndex(const std::vector<unsigned int> &listIndex);
+    // Return the catalog, which holds the full list and the tooltips
+    const Util::Catalog &catalog() const { return _catalog; }
+    // Return the full list / the tooltips as lists. Every entry is copied.
+    QStringList fullList() const { return _catalog.names(); }
+    QStringList tooltipList() const { return _catalog.tooltips(); }
+    // Return the short list
+    const std::vector<unsigned int> &shortListIndex() const { return _shortListIndex; }
+    // Return true once there's a short list to switch to
+    bool hasShortList() const { return _shortListEnabled; }
+    // Show the full list or the short list in the available list. Only used with a short list.
+    void setFullListShown(bool shown);
+    bool isFullListShown() const { return _fullListShown; }
+    // Return true if the available list is taken from the full list
+    bool isFullList() const { return !_shortListEnabled || _fullListShown; }
+    // Return the sorted index of the full list for the items of the available list. It costs
+    // the selected items, the full list / 64, and the items returned. It's only needed when the
+    // shown items change (full / short list, view, new full list), the edits of the selection
+    // notify the available indexes they remove or insert.
+    std::vector<unsigned int> availableIndex() const;
+    // Return the fingerprint of the full list. It's computed once after the full list is set.
+    quint64 fullListFingerprint() const;
+
+public: // Views
+    // Most distinct tooltips which are made into views
+    static const int MaxTooltipViews = 64;
+    // Add a named view of the full list. Out of range indexes are dropped. Return the view number.
+    // The views are removed when a new full list is set.
+    int addView(const QString &name, const std::vector<unsigned int> &index);
+    // Make one view per distinct tooltip (e.g. a category), in the order they first appear.
+    // They follow the full list as it's set or appended. Tooltips with more than
+    // MaxTooltipViews distinct values aren't categories, they get no views. Disabling it removes
+    // all the views.
+    void setViewsFromTooltips(bool enabled);
+    bool viewsFromTooltips() const { return _viewsFromTooltips; }
+    // Remove all the views
+    void clearViews();
+    // Return the number / the names of the views
+    int viewCount() const { return int(_views.size()); }
+    QStringList viewNames() const;
+    // Narrow the available list to a view, -1 for no view
+    void setCurrentView(int view);
+    int currentView() const { return _currentView; }
+
+public: // Selection
+    // Return the number of selected items
+    unsigned int selectedCount() const { return _selected.size(); }
+    // Return the full list index of each selected item. It walks the whole list.
+    std::vector<unsigned int> selectedIndex() const;
+    // Return true if the full list index is selected. It doesn't walk the list.
+    bool isSelected(unsigned int fullIndex) const { return _selectedSet.contains(fullIndex); }
+    // Return the set of the selected full list indexes
+    const IndexSet &selectedSet() const { return _selectedSet; }
+    // Return the full list index / the alias of the selected item at the row
+    unsigned int selectedIndexAt(int row) const { return _selected.at(unsigned(row)).index; }
+    const QString &alias(int row) const { return _selected.at(unsigned(row)).alias; }
+    // Return the original names / the aliases of the selected items
+    QStringList selectedRawList() const;
+    QStringList selectedAliasList() const;
+    // Insert items to the selected list at the row, and take them out of the available list
+    void insertItems(int row, const std::vector<unsigned int> &index, const QStringList &aliasList);
+    // Append items with their default aliases
+    void appendItems(const std::vector<unsigned int> &index);
+    // Remove runs of rows from the selected list, and put them back to the available list
+    void takeItems(const std::vector<std::pair<int,int>> &runs);
+    // Move the rows from fromRows to toRows (both in ascending order, same size). toRows are
+    // the rows after the move. Observers get one move per block of rows which stay together.
+    void moveItems(const std::vector<int> &fromRows, const std::vector<int> &toRows);
+    // Rename the selected item at the row
+    void renameItem(int row, const QString &alias);
+    // Replace the whole selection. The aliases are sanitized if the names are checked.
+    void loadItems(const std::vector<unsigned int> &index, const QStringList &aliasList);
+    // Replace the whole selection by names of the full list. Names which aren't found are skipped.
+    void loadItemsFromLists(const QStringList &sList_raw, const QStringList &sList_alias);
+
+public: // Names
+    // Set to true will replace the characters not allowed by the naming policy in the aliases
+    void setValidNameCheck(bool state) { _validNameCheck = state; }
+    bool validNameCheck() const { return _validNameCheck; }
+    // Set the characters allowed in an alias and their replacement
+    void setNamingPolicy(const Util::NamingPolicy &policy) { _namingPolicy = policy; }
+    const Util::NamingPolicy &namingPolicy() const { return _namingPolicy; }
+    // Return the alias an item gets when it's added
+    QString defaultAlias(unsigned int fullIndex) const;
+    QStringList defaultAliases(const std::vector<unsigned int> &index) const;
+    // Return the alias with the characters not allowed replaced, if the names are checked
+    QString validAlias(const QString &alias) const;
+    // Return the number of selected items using the alias
+    unsigned int aliasCount(const QString &alias) const { return _aliasCount.value(alias); }
+    // Return an alias which isn't used yet, made from the alias and a suffix
+    QString uniqueAlias(const QString &alias);
+
+public: // Files
+    // Read the selection from a CSV file or a snapshot. Return a Util::ListFileLoader status.
+    int readListFromFile(const QString &filename);
+    // Save the selection as a CSV file. The rows are streamed to a temporary file which replaces
+    // the target once it's complete. Return a Util::ListCsvProcessor status.
+    int saveListToFile(const QString &filename) const;
+    // Save the selection as a binary snapshot. Return a Util::ListSnapshotProcessor status.
+    int saveSnapshotToFile(const QString &filename) const;
+    // Return the selection as a snapshot. Only the aliases which were renamed are kept.
+    Util::ListSnapshot snapshot() const;
+
+private:
+    // Call a function for every observer
+    template <typename Function>
+    void notify(Function function) {
+        for (SelectionObserver *observer : _observers) {
+            function(observer);
+        }
+    }
+    // Set the short list index and its bitmap. Duplicate and out of range indexes are dropped.
+    void assignShortListIndex(const std::vector<unsigned int> &listIndex);
+    // Return true if the full list index is shown in the available list when it's not selected
+    bool isShown(unsigned int fullIndex) const;
+    // Add the items from the full list index first to the views of their tooltips. Return true
+    // if a view was added.
+    bool addTooltipViews(unsigned int first);
+    // Remove the tooltip views and keep the named ones. Return true if a view was removed.
+    bool removeTooltipViews();
+    // Remove the views and make the tooltip views again. The available list isn't notified.
+    void rebuildViews();
+    // Add / remove one selection of a full list index in the selected set
+    void selectIndex(unsigned int fullIndex);
+    void unselectIndex(unsigned int fullIndex);
+    // Make the selected set again from the selected list
+    void rebuildSelectedSet();
+    // Add / remove one use of an alias in the alias count
+    void countAlias(const QString &alias);
+    void uncountAlias(const QString &alias);
+
+private:
+    std::vector<SelectionObserver*> _observers;
+    Util::Catalog _catalog;
+    std::vector<unsigned int> _shortListIndex;
+    IndexBitmap _shortListBits;
+    bool _shortListEnabled = false;
+    bool _fullListShown = true;
+    mutable quint64 _fullListFingerprint = 0;
+    mutable bool _fullListFingerprintValid = false;
+    // Named views of the full list, and the view of each tooltip code (-1 if none)
+    struct View {
+        QString name;
+        IndexBitmap bits;
+    };
+    std::vector<View> _views;
+    std::vector<int> _tooltipViews;
+    bool _viewsFromTooltips = false;
+    int _currentView = -1;
+    // The selected items: full list index and alias of each row
+    SelectionSequence _selected;
+    // The selected full list indexes as a set, and how many more times the indexes which are
+    // selected more than once are selected
+    IndexSet _selectedSet;
+    QHash<unsigned int, unsigned int> _selectedRepeats;
+    // Number of selected items using each alias, and the next suffix to try for a duplicate alias
+    QHash<QString, unsigned int> _aliasCount;
+    QHash<QString, unsigned int> _aliasSuffix;
+    bool _validNameCheck = false;
+    Util::NamingPolicy _namingPolicy;
+};
+
+}
+
+#endif // SELECTIONENGINE_H
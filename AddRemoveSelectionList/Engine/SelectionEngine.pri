@@ -0,0 +1,37 @@
+# UI-free selection engine and the file utilities. Only needs QtCore.
+# Included by Engine.pro (static library) and by AddRemoveSelection.pri.
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    $$PWD/SelectionEngine.cpp \
+    $$PWD/SelectionSequence.cpp \
+    $$PWD/SelectionJournal.cpp \
+    $$PWD/SelectionPublisher.cpp \
+    $$PWD/IndexBitmap.cpp \
+    $$PWD/IndexSet.cpp \
+    $$PWD/../Util/ListCsvProcessor.cpp \
+    $$PWD/../Util/ListCsvWriter.cpp \
+    $$PWD/../Util/ListSnapshotProcessor.cpp \
+    $$PWD/../Util/ListFileLoader.cpp \
+    $$PWD/../Util/CatalogCsvReader.cpp \
+    $$PWD/../Util/Catalog.cpp \
+    $$PWD/../Util/NameSanitizer.cpp \
+    $$PWD/../Util/Trace.cpp
+
+HEADERS += \
+    $$PWD/SelectionEngine.h \
+    $$PWD/SelectionObserver.h \
+    $$PWD/SelectionSequence.h \
+    $$PWD/SelectionJournal.h \
+    $$PWD/SelectionPublisher.h \
+    $$PWD/IndexBitmap.h \
+    $$PWD/IndexSet.h \
+    $$PWD/../Util/ListCsvProcessor.h \
+    $$PWD/../Util/ListCsvWriter.h \
+    $$PWD/../Util/ListSnapshotProcessor.h \
+    $$PWD/../Util/ListFileLoader.h \
+    $$PWD/../Util/CatalogCsvReader.h \
+    $$PWD/../Util/Catalog.h \
+    $$PWD/../Util/NameSanitizer.h \
+    $$PWD/../Util/Trace.h
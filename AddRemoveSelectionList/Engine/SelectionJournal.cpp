@@ -0,0 +1,388 @@
+#include "SelectionJournal.h"
+#include "SelectionEngine.h"
+#include <Util/ListSnapshotProcessor.h>
+#include <Util/ListFileLoader.h>
+#include <Util/Trace.h>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace Engine
+{
+
+namespace
+{
+
+const char JournalSignature[4] = {'A', 'R', 'S', 'J'};
+const quint16 JournalVersion = 1;
+const int HeaderSize = 4 + 2 + 2 + 4;
+const int RecordHeaderSize = 4 + 4;
+
+enum RecordType { InsertRecord = 1, RemoveRecord = 2, MoveRecord = 3, RenameRecord = 4 };
+
+void appendU16(QByteArray &buffer, quint16 value) {
+    uchar bytes[2];
+    qToLittleEndian(value, bytes);
+    buffer.append(reinterpret_cast<const char *>(bytes), 2);
+}
+
+void appendU32(QByteArray &buffer, quint32 value) {
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    buffer.append(reinterpret_cast<const char *>(bytes), 4);
+}
+
+void appendString(QByteArray &buffer, const QString &str) {
+    QByteArray utf8 = str.toUtf8();
+    appendU32(buffer, quint32(utf8.size()));
+    buffer.append(utf8);
+}
+
+// 32-bit FNV-1a of a record payload
+quint32 checksum(const uchar *data, qint64 size) {
+    quint32 hash = 2166136261U;
+    for (qint64 idx = 0 ; idx < size ; ++idx) {
+        hash = (hash ^ data[idx]) * 16777619U;
+    }
+    return hash;
+}
+
+/*
+ * A cursor over a record. Every read is bounds checked, a read past the end puts the cursor in
+ * the failed state and returns zero / empty values from then on.
+*/
+class RecordReader {
+public:
+    RecordReader(const uchar *data, qint64 size) : _pos(data), _end(data + size) { ; }
+    bool failed() const { return _failed; }
+    const uchar *take(qint64 size) {
+        if (_failed || size < 0 || (_end - _pos) < size) {
+            _failed = true;
+            return nullptr;
+        }
+        const uchar *data = _pos;
+        _pos += size;
+        return data;
+    }
+    quint8 u8() { const uchar *data = take(1); return (data) ? *data : 0; }
+    quint32 u32() { const uchar *data = take(4); return (data) ? qFromLittleEndian<quint32>(data) : 0; }
+    QString string() {
+        quint32 size = u32();
+        const uchar *data = take(qint64(size));
+        return (data) ? QString::fromUtf8(reinterpret_cast<const char *>(data), int(size)) : QString();
+    }
+    bool atEnd() const { return _pos == _end; }
+private:
+    const uchar *_pos;
+    const uchar *_end;
+    bool _failed = false;
+};
+
+}
+
+const int SelectionJournal::MinCompactionRecords;
+
+SelectionJournal::SelectionJournal(SelectionEngine *engine) : _engine(engine) {
+}
+
+SelectionJournal::~SelectionJournal() {
+    close();
+}
+
+int SelectionJournal::open(const QString &filename) {
+    close();
+    _filename = filename;
+    _status = compact();
+    if (_status == NoError) {
+        _engine->addObserver(this);
+        _observing = true;
+    }
+    return _status;
+}
+
+/*
+ * The journal stops observing while the snapshot is loaded and the records are replayed, then
+ * it's reopened, which compacts the file. The file is mapped and read in place.
+*/
+int SelectionJournal::recover(const QString &filename) {
+    Util::TraceSpan span("SelectionJournal::recover");
+    close();
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return FileError;
+    }
+    const qint64 size = file.size();
+    const uchar *data = (size >= HeaderSize) ? file.map(0, size) : nullptr;
+    if (!data) {
+        return (size >= HeaderSize) ? FileError : FormatError;
+    }
+    const qint64 snapshotSize = qint64(qFromLittleEndian<quint32>(data + 8));
+    Util::ListSnapshot snapshot;
+    int status = NoError;
+    bool loaded = false;
+    if (std::memcmp(data, JournalSignature, 4) != 0 || qFromLittleEndian<quint16>(data + 4) != JournalVersion ||
+            snapshotSize > size - HeaderSize) {
+        status = FormatError;
+    }
+    else {
+        status = Util::ListSnapshotProcessor::fromData(data + HeaderSize, snapshotSize, snapshot);
+    }
+    if (status == NoError) {
+        // The records refer to rows of the selection, so they only apply to the same full list
+        const bool sameFullList = (snapshot.fingerprint == _engine->fullListFingerprint() &&
+                                   snapshot.fullListSize == unsigned(_engine->catalog().size()));
+        Util::ListFileLoader loader(QString(), _engine->catalog(), _engine->fullListFingerprint());
+        loader.resolveSnapshot(snapshot);
+        _engine->loadItems(loader.index(), loader.aliasList());
+        loaded = true;
+        const uchar *records = data + HeaderSize + snapshotSize;
+        const qint64 recordsSize = size - HeaderSize - snapshotSize;
+        if (sameFullList) {
+            status = (replay(records, recordsSize)) ? NoError : FormatError;
+        }
+        else if (recordsSize >= RecordHeaderSize) {
+            status = CatalogChanged;
+        }
+    }
+    file.unmap(const_cast<uchar *>(data));
+    file.close();
+    span.setItems(_engine->selectedCount());
+    if (!loaded) {
+        return status; // The file is left as it is
+    }
+    if (status != NoError) {
+        // Reopening compacts the records which weren't replayed away, so the file is copied
+        // first. If it can't be, it's left as it is and not journaled to.
+        QFile::remove(backupFilename(filename));
+        if (!QFile::copy(filename, backupFilename(filename))) {
+            return FileError;
+        }
+    }
+    int openStatus = open(filename);
+    return (status != NoError) ? status : openStatus;
+}
+
+QString SelectionJournal::backupFilename(const QString &filename) {
+    return filename + ".old";
+}
+
+void SelectionJournal::close() {
+    if (_observing) {
+        _engine->removeObserver(this);
+        _observing = false;
+    }
+    _file.close();
+    _filename.clear();
+    _recordCount = 0;
+}
+
+int SelectionJournal::compact() {
+    if (_filename.isEmpty()) {
+        return FileError;
+    }
+    Util::TraceSpan span("SelectionJournal::compact");
+    span.setItems(_engine->selectedCount());
+    QByteArray snapshot = Util::ListSnapshotProcessor::toData(_engine->snapshot());
+    QByteArray header;
+    header.append(JournalSignature, 4);
+    appendU16(header, JournalVersion);
+    appendU16(header, 0);
+    appendU32(header, quint32(snapshot.size()));
+    // The appending file still refers to the previous file once it's replaced
+    _file.close();
+    QSaveFile file(_filename);
+    if (!file.open(QIODevice::WriteOnly) || file.write(header) != header.size() ||
+            file.write(snapshot) != snapshot.size() || !file.commit()) {
+        _status = FileError;
+        return _status;
+    }
+    _recordCount = 0;
+    _catalogSize = _engine->catalog().size();
+    _file.setFileName(_filename);
+    _status = (_file.open(QIODevice::WriteOnly | QIODevice::Append)) ? NoError : FileError;
+    return _status;
+}
+
+void SelectionJournal::availableListReset() {
+    if (isOpen()) { // The full list was replaced
+        compact();
+    }
+}
+
+void SelectionJournal::availableIndexesRenumbered(const std::vector<int> &) {
+    if (isOpen()) { // The full list was reloaded, the records would refer to the previous one
+        compact();
+    }
+}
+
+void SelectionJournal::selectedItemsInserted(int first, int last) {
+    if (!isOpen()) {
+        return;
+    }
+    QByteArray payload;
+    payload.append(char(InsertRecord));
+    appendU32(payload, quint32(first));
+    appendU32(payload, quint32(last - first + 1));
+    for (int row = first ; row <= last ; ++row) {
+        appendU32(payload, _engine->selectedIndexAt(row));
+        appendString(payload, _engine->alias(row));
+    }
+    appendRecord(payload);
+}
+
+void SelectionJournal::selectedItemsRemoved(int first, int last) {
+    if (!isOpen()) {
+        return;
+    }
+    QByteArray payload;
+    payload.append(char(RemoveRecord));
+    appendU32(payload, quint32(first));
+    appendU32(payload, quint32(last));
+    appendRecord(payload);
+}
+
+void SelectionJournal::selectedItemsMoved(int first, int last, int destRow) {
+    if (!isOpen()) {
+        return;
+    }
+    QByteArray payload;
+    payload.append(char(MoveRecord));
+    appendU32(payload, quint32(first));
+    appendU32(payload, quint32(last));
+    appendU32(payload, quint32(destRow));
+    appendRecord(payload);
+}
+
+void SelectionJournal::selectedItemRenamed(int row) {
+    if (!isOpen()) {
+        return;
+    }
+    QByteArray payload;
+    payload.append(char(RenameRecord));
+    appendU32(payload, quint32(row));
+    appendString(payload, _engine->alias(row));
+    appendRecord(payload);
+}
+
+void SelectionJournal::selectedListReset() {
+    if (isOpen()) { // A new selection was loaded
+        compact();
+    }
+}
+
+/*
+ * The record is written with a single call and flushed to the system, so a crash of the
+ * program loses nothing. It isn't synced to the disk. The edit is already applied when the
+ * record is written, so a compaction instead of the record keeps it as well.
+*/
+void SelectionJournal::appendRecord(const QByteArray &payload) {
+    if (_catalogSize != _engine->catalog().size() ||
+            _recordCount >= std::max(MinCompactionRecords, int(_engine->selectedCount()))) {
+        compact();
+        return;
+    }
+    QByteArray record;
+    record.reserve(RecordHeaderSize + payload.size());
+    appendU32(record, quint32(payload.size()));
+    appendU32(record, checksum(reinterpret_cast<const uchar *>(payload.constData()), payload.size()));
+    record.append(payload);
+    if (_file.write(record) != record.size() || !_file.flush()) {
+        _status = FileError;
+        _file.close();
+        return;
+    }
+    ++_recordCount;
+}
+
+bool SelectionJournal::replay(const uchar *data, qint64 size) {
+    qint64 pos = 0;
+    while (size - pos >= RecordHeaderSize) {
+        const qint64 payloadSize = qint64(qFromLittleEndian<quint32>(data + pos));
+        const quint32 payloadChecksum = qFromLittleEndian<quint32>(data + pos + 4);
+        const uchar *payload = data + pos + RecordHeaderSize;
+        if (payloadSize > size - pos - RecordHeaderSize) {
+            break; // The last record was cut short
+        }
+        if (checksum(payload, payloadSize) != payloadChecksum) {
+            // Only the last record can be half written. A damaged record with records behind it
+            // means they can't be replayed.
+            return pos + RecordHeaderSize + payloadSize == size;
+        }
+        if (!applyRecord(payload, payloadSize)) {
+            return false;
+        }
+        pos += RecordHeaderSize + payloadSize;
+    }
+    return true;
+}
+
+bool SelectionJournal::applyRecord(const uchar *data, qint64 size) {
+    RecordReader reader(data, size);
+    const quint32 count = _engine->selectedCount();
+    const quint32 catalogSize = quint32(_engine->catalog().size());
+    switch (reader.u8()) {
+    case InsertRecord: {
+        const quint32 row = reader.u32();
+        const quint32 nItem = reader.u32();
+        std::vector<unsigned int> index;
+        QStringList aliasList;
+        index.reserve(std::min<quint32>(nItem, quint32(size / 8)));
+        for (quint32 idx = 0 ; idx < nItem && !reader.failed() ; ++idx) {
+            index.push_back(reader.u32());
+            aliasList << reader.string();
+        }
+        for (const unsigned int &idx : index) {
+            if (idx >= catalogSize) {
+                return false;
+            }
+        }
+        if (reader.failed() || !reader.atEnd() || nItem == 0 || row > count) {
+            return false;
+        }
+        _engine->insertItems(int(row), index, aliasList);
+        return true;
+    }
+    case RemoveRecord: {
+        const quint32 first = reader.u32();
+        const quint32 last = reader.u32();
+        if (reader.failed() || !reader.atEnd() || first > last || last >= count) {
+            return false;
+        }
+        _engine->takeItems(std::vector<std::pair<int,int>>(1, std::make_pair(int(first), int(last))));
+        return true;
+    }
+    case MoveRecord: {
+        const quint32 first = reader.u32();
+        const quint32 last = reader.u32();
+        const quint32 destRow = reader.u32();
+        if (reader.failed() || !reader.atEnd() || first > last || last >= count || destRow > count ||
+                (destRow >= first && destRow <= last + 1)) {
+            return false;
+        }
+        // The block lands in front of destRow, which is a row before the move
+        const int blockSize = int(last - first + 1);
+        const int toFirst = (destRow > last) ? int(destRow) - blockSize : int(destRow);
+        std::vector<int> fromRows, toRows;
+        for (int idx = 0 ; idx < blockSize ; ++idx) {
+            fromRows.push_back(int(first) + idx);
+            toRows.push_back(toFirst + idx);
+        }
+        _engine->moveItems(fromRows, toRows);
+        return true;
+    }
+    case RenameRecord: {
+        const quint32 row = reader.u32();
+        QString alias = reader.string();
+        if (reader.failed() || !reader.atEnd() || row >= count) {
+            return false;
+        }
+        _engine->renameItem(int(row), alias);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+}
@@ -0,0 +1,106 @@
+#ifndef SELECTIONJOURNAL_H
+#define SELECTIONJOURNAL_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include "SelectionObserver.h"
+
+namespace Engine
+{
+
+class SelectionEngine;
+
+/*
+ * SelectionJournal keeps the selection of an engine on disk while it's edited. The file starts
+ * with a snapshot of the selection (Util::ListSnapshotProcessor format) followed by one record
+ * per edit, appended and flushed as soon as the engine reports it, so saving an edit costs the
+ * size of the edit and not of the selection. Once there are more records than selected items
+ * (and at least MinCompactionRecords), the file is compacted: it's rewritten as a snapshot
+ * without records, through a temporary file which replaces it at once. A new or reloaded
+ * full list, or a new selection, is compacted right away.
+ *
+ * recover() loads the snapshot and replays the records. A last record cut short by a crash ends
+ * the replay, a damaged record with others behind it is an error. The records are only replayed
+ * on the full list they were written for (same fingerprint), otherwise only the snapshot is
+ * loaded, matched by names. When records can't be replayed, the file is copied to
+ * backupFilename() before it's compacted, so the edits can still be looked at. All numbers are
+ * little endian.
+ *
+ *   Header  : "ARSJ", quint16 version, quint16 reserved, quint32 snapshot size, snapshot
+ *   Record  : quint32 payload size, quint32 FNV-1a checksum of the payload, payload
+ *   Payload : quint8 type, then
+ *             Insert (1) : quint32 row, quint32 count, (quint32 index, alias) x count
+ *             Remove (2) : quint32 first, quint32 last
+ *             Move   (3) : quint32 first, quint32 last, quint32 destination row before the move
+ *             Rename (4) : quint32 row, alias
+ *   Alias   : quint32 byte size, UTF-8 bytes
+*/
+class SelectionJournal : private SelectionObserver {
+
+public:
+    // Status code. Same as Util::ListSnapshotProcessor, and CatalogChanged when the records
+    // were written for another full list.
+    enum Status { NoError = 0, FileError = 1, FormatError = 2, CatalogChanged = 4 };
+    // The file isn't compacted before it has this many records
+    static const int MinCompactionRecords = 1024;
+
+public:
+    // The engine must outlive the journal
+    explicit SelectionJournal(SelectionEngine *engine);
+    ~SelectionJournal() override;
+    // Start journaling to the file, which is rewritten with the current selection
+    int open(const QString &filename);
+    // Load the selection from the file, then keep journaling to it. If a record is damaged or
+    // doesn't fit the selection, the replay stops there and FormatError is returned. If the full
+    // list changed since the records were written, only the snapshot is loaded and
+    // CatalogChanged is returned. Either way the selection is loaded, and the file is copied to
+    // backupFilename() before it's compacted.
+    int recover(const QString &filename);
+    // Return the copy of a journal file kept when its records don't fit the full list
+    static QString backupFilename(const QString &filename);
+    // Stop journaling. The file is kept.
+    void close();
+    // Return true while the edits are written to the file
+    bool isOpen() const { return _file.isOpen(); }
+    // Return the journal file, empty if none
+    const QString &filename() const { return _filename; }
+    // Return the status of the last write. The journal stops at the first failed write.
+    int status() const { return _status; }
+    // Rewrite the file as a snapshot of the current selection
+    int compact();
+    // Return the number of records since the last compaction
+    int recordCount() const { return _recordCount; }
+
+private: // SelectionObserver
+    void availableListReset() override;
+    void availableIndexesRenumbered(const std::vector<int> &newIndex) override;
+    void selectedItemsInserted(int first, int last) override;
+    void selectedItemsRemoved(int first, int last) override;
+    void selectedItemsMoved(int first, int last, int destRow) override;
+    void selectedItemRenamed(int row) override;
+    void selectedListReset() override;
+
+private:
+    // Append a record to the file, or compact it if it's due
+    void appendRecord(const QByteArray &payload);
+    // Replay the records on the engine. Return false if a record doesn't fit the selection.
+    bool replay(const uchar *data, qint64 size);
+    // Apply the payload of one record
+    bool applyRecord(const uchar *data, qint64 size);
+
+private:
+    SelectionEngine *_engine;
+    QString _filename;
+    QFile _file;
+    bool _observing = false;
+    int _status = NoError;
+    int _recordCount = 0;
+    // Size of the full list at the last compaction. Appending to the full list changes its
+    // fingerprint, so the next edit compacts the file.
+    int _catalogSize = 0;
+};
+
+}
+
+#endif // SELECTIONJOURNAL_H
@@ -0,0 +1,56 @@
+#ifndef SELECTIONOBSERVER_H
+#define SELECTIONOBSERVER_H
+
+#include <vector>
+
+namespace Engine
+{
+
+/*
+ * SelectionObserver is notified of the changes of a SelectionEngine. The selected list
+ * follows the contract of the rows of a Qt model: the "about to" function is called before
+ * the change and the other one after it, each contiguous block of rows at once, so a model
+ * can forward them as they are. The available list is only described by full list indexes,
+ * a view decides by itself which rows they are. All functions do nothing by default.
+*/
+class SelectionObserver {
+
+public:
+    virtual ~SelectionObserver() { ; }
+
+    // The full list, the tooltips or the short list have been replaced. The available list
+    // must be rebuilt from SelectionEngine::availableIndex().
+    virtual void availableListReset() { ; }
+    // The available list has changed as a whole, e.g. switched between the full and the short
+    // list, or a new selection was loaded. SelectionEngine::availableIndex() is the new list.
+    virtual void availableListChanged() { ; }
+    // Views have been added or removed. The current view might have been reset.
+    virtual void availableViewsChanged() { ; }
+    // Indexes (sorted) were appended to the end of the available list
+    virtual void availableIndexesAppended(const std::vector<unsigned int> &index) { (void)index; }
+    // Indexes (sorted) are available again. Some of them might already be in the list.
+    virtual void availableIndexesInserted(const std::vector<unsigned int> &index) { (void)index; }
+    // Indexes (sorted) are not available anymore
+    virtual void availableIndexesRemoved(const std::vector<unsigned int> &index) { (void)index; }
+    // The full list was reloaded and the available indexes have a new number, newIndex[old],
+    // in the same order. The indexes which are gone have already been removed.
+    virtual void availableIndexesRenumbered(const std::vector<int> &newIndex) { (void)newIndex; }
+
+    // Rows [first, last] of the selected list
+    virtual void selectedItemsAboutToBeInserted(int first, int last) { (void)first; (void)last; }
+    virtual void selectedItemsInserted(int first, int last) { (void)first; (void)last; }
+    virtual void selectedItemsAboutToBeRemoved(int first, int last) { (void)first; (void)last; }
+    virtual void selectedItemsRemoved(int first, int last) { (void)first; (void)last; }
+    // Rows [first, last] are moved in front of destRow, which is a row before the move
+    virtual void selectedItemsAboutToBeMoved(int first, int last, int destRow) { (void)first; (void)last; (void)destRow; }
+    virtual void selectedItemsMoved(int first, int last, int destRow) { (void)first; (void)last; (void)destRow; }
+    // The alias of a selected item has changed
+    virtual void selectedItemRenamed(int row) { (void)row; }
+    // The whole selected list is replaced
+    virtual void selectedListAboutToBeReset() { ; }
+    virtual void selectedListReset() { ; }
+};
+
+}
+
+#endif // SELECTIONOBSERVER_H
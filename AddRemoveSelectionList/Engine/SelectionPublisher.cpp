@@ -0,0 +1,70 @@
+#include "SelectionPublisher.h"
+#include "SelectionEngine.h"
+#include <Util/Trace.h>
+
+namespace Engine
+{
+
+SelectionPublisher::SelectionPublisher(SelectionEngine *engine, QObject *parent) :
+    QObject(parent), _engine(engine), _version(0) {
+    publish();
+    _engine->addObserver(this);
+}
+
+SelectionPublisher::~SelectionPublisher() {
+    _engine->removeObserver(this);
+}
+
+QString SelectionState::rawName(unsigned int row) const {
+    const unsigned int idx = index->at(row);
+    return (idx < unsigned(catalog.size())) ? catalog.name(int(idx)) : QString();
+}
+
+QStringList SelectionState::rawList() const {
+    QStringList rawList;
+    rawList.reserve(int(size()));
+    for (unsigned int row = 0 ; row < size() ; ++row) {
+        rawList << rawName(row);
+    }
+    return rawList;
+}
+
+void SelectionPublisher::schedule(int changes) {
+    _changes |= changes;
+    if (!_scheduled) {
+        _scheduled = true;
+        QMetaObject::invokeMethod(this, "publish", Qt::QueuedConnection);
+    }
+}
+
+/*
+ * The new state starts as a copy of the previous one, which only shares its parts, and the
+ * parts which changed are built again. The catalog is copied every time, which is only a
+ * reference as long as the engine doesn't change it.
+*/
+void SelectionPublisher::publish() {
+    Util::TraceSpan span("SelectionPublisher::publish");
+    span.setItems(_engine->selectedCount());
+    _scheduled = false;
+    std::shared_ptr<const SelectionState> previous = current();
+    std::shared_ptr<SelectionState> state = (previous) ? std::make_shared<SelectionState>(*previous)
+                                                       : std::make_shared<SelectionState>();
+    state->version = _version.load(std::memory_order_relaxed) + 1;
+    state->catalog = _engine->catalog();
+    if ((_changes & IndexChanged) || !state->index) {
+        state->index = std::make_shared<const std::vector<unsigned int>>(_engine->selectedIndex());
+    }
+    if (_changes & AliasesChanged) {
+        state->aliasList = _engine->selectedAliasList();
+    }
+    if ((_changes & SetChanged) || !state->indexSet) {
+        state->indexSet = std::make_shared<const IndexSet>(_engine->selectedSet());
+    }
+    _changes = 0;
+    // The state is complete before it's visible to the readers
+    std::atomic_store_explicit(&_current, std::shared_ptr<const SelectionState>(state), std::memory_order_release);
+    _version.store(state->version, std::memory_order_release);
+    emit published(state->version);
+}
+
+}
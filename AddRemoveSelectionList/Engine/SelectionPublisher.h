@@ -0,0 +1,100 @@
+#ifndef SELECTIONPUBLISHER_H
+#define SELECTIONPUBLISHER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <QObject>
+#include <QStringList>
+#include <Util/Catalog.h>
+#include "SelectionObserver.h"
+#include "IndexSet.h"
+
+namespace Engine
+{
+
+class SelectionEngine;
+
+/*
+ * SelectionState is a published copy of a selection. It never changes once it's published, so
+ * it can be read from any thread without locking. The parts which didn't change since the
+ * previous state are shared with it, so a rename doesn't copy the indexes and a move doesn't
+ * copy the set. The raw names aren't copied at all: they're read from the catalog the
+ * selection refers to, which is implicitly shared with the engine.
+*/
+struct SelectionState {
+    // Increases with every publication
+    quint64 version = 0;
+    // Full list index and alias of each selected item, in the selected list order
+    std::shared_ptr<const std::vector<unsigned int>> index;
+    QStringList aliasList;
+    // The selected full list indexes, for membership tests
+    std::shared_ptr<const IndexSet> indexSet;
+    // The full list the indexes refer to
+    Util::Catalog catalog;
+    // Return the number of selected items
+    unsigned int size() const { return unsigned(index->size()); }
+    // Return the raw name of the item at the row, empty for an index which isn't in the full list
+    QString rawName(unsigned int row) const;
+    // Return the raw names of all the items
+    QStringList rawList() const;
+};
+
+/*
+ * SelectionPublisher follows a SelectionEngine and publishes its selection as a new
+ * SelectionState after every change, RCU style: the state is built on the engine's thread and
+ * swapped in with an atomic store of a shared pointer, and readers on other threads load the
+ * pointer and keep the state alive for as long as they use it. A reader never waits for the
+ * state to be built and always sees a whole selection. Only the parts the changes touched are
+ * built again: the rows for inserted, removed and moved items, the aliases for renamed items
+ * and the set when items come in or go out.
+ *
+ * The changes are gathered until control returns to the event loop, so an operation which
+ * notifies many blocks of rows is published once. Without an event loop, call publish().
+*/
+class SelectionPublisher : public QObject, private SelectionObserver {
+    Q_OBJECT
+
+public:
+    // The engine must outlive the publisher. The current selection is published right away.
+    explicit SelectionPublisher(SelectionEngine *engine, QObject *parent = nullptr);
+    ~SelectionPublisher() override;
+    // Return the last published selection, never null. It can be called from any thread.
+    std::shared_ptr<const SelectionState> current() const { return std::atomic_load_explicit(&_current, std::memory_order_acquire); }
+    // Return the version of the last published selection, so a reader can check for a change
+    // without loading it. It can be called from any thread.
+    quint64 version() const { return _version.load(std::memory_order_acquire); }
+
+public slots:
+    // Publish the selection of the engine now. Only from the thread of the engine.
+    void publish();
+
+signals:
+    void published(quint64 version);
+
+private: // SelectionObserver
+    void availableListReset() override { schedule(AllChanged); }
+    void availableIndexesRenumbered(const std::vector<int> &) override { schedule(AllChanged); }
+    void selectedItemsInserted(int, int) override { schedule(AllChanged); }
+    void selectedItemsRemoved(int, int) override { schedule(AllChanged); }
+    void selectedItemsMoved(int, int, int) override { schedule(IndexChanged | AliasesChanged); }
+    void selectedItemRenamed(int) override { schedule(AliasesChanged); }
+    void selectedListReset() override { schedule(AllChanged); }
+
+private:
+    // Parts of the state to build again
+    enum Change { IndexChanged = 0x1, AliasesChanged = 0x2, SetChanged = 0x4, AllChanged = 0x7 };
+    // Publish once control returns to the event loop
+    void schedule(int changes);
+
+private:
+    SelectionEngine *_engine;
+    std::shared_ptr<const SelectionState> _current;
+    std::atomic<quint64> _version;
+    bool _scheduled = false;
+    int _changes = AllChanged;
+};
+
+}
+
+#endif // SELECTIONPUBLISHER_H
@@ -0,0 +1,181 @@
+#include "SelectionSequence.h"
+
+namespace Engine
+{
+
+SelectionSequence::SelectionSequence() {
+
+}
+
+void SelectionSequence::insert(unsigned int row, const std::vector<Item> &items) {
+    if (items.empty()) {
+        return;
+    }
+    int left, right;
+    split(_root, row, left, right);
+    _root = merge(merge(left, build(items)), right);
+}
+
+std::vector<SelectionSequence::Item> SelectionSequence::take(unsigned int first, unsigned int last) {
+    int left, middle, right;
+    split(_root, last + 1, middle, right);
+    split(middle, first, left, middle);
+    _root = merge(left, right);
+    std::vector<Item> items;
+    items.reserve(nodeSize(middle));
+    release(middle, items);
+    return items;
+}
+
+void SelectionSequence::move(unsigned int first, unsigned int last, unsigned int row) {
+    int left, middle, right;
+    split(_root, last + 1, middle, right);
+    split(middle, first, left, middle);
+    split(merge(left, right), row, left, right);
+    _root = merge(merge(left, middle), right);
+}
+
+void SelectionSequence::assign(const std::vector<Item> &items) {
+    clear();
+    _root = build(items);
+}
+
+void SelectionSequence::clear() {
+    _nodes.clear();
+    _freeNodes.clear();
+    _root = -1;
+}
+
+int SelectionSequence::find(unsigned int row) const {
+    int node = _root;
+    while (node >= 0) {
+        const Node &current = _nodes[unsigned(node)];
+        const unsigned int leftSize = nodeSize(current.left);
+        if (row < leftSize) {
+            node = current.left;
+        }
+        else if (row == leftSize) {
+            break;
+        }
+        else {
+            row -= leftSize + 1;
+            node = current.right;
+        }
+    }
+    return node;
+}
+
+/*
+ * The nodes are added in row order to the right spine of the tree. A new node takes over the
+ * part of the spine with lower priorities as its left subtree, which is complete by then, so the
+ * sizes are updated as the nodes leave the spine.
+*/
+int SelectionSequence::build(const std::vector<Item> &items) {
+    std::vector<int> spine;
+    for (const Item &item : items) {
+        const int node = newNode(item);
+        int last = -1;
+        while (!spine.empty() && _nodes[unsigned(spine.back())].priority < _nodes[unsigned(node)].priority) {
+            last = spine.back();
+            spine.pop_back();
+            update(last);
+        }
+        _nodes[unsigned(node)].left = last;
+        if (!spine.empty()) {
+            _nodes[unsigned(spine.back())].right = node;
+        }
+        spine.push_back(node);
+    }
+    while (spine.size() > 1) {
+        update(spine.back());
+        spine.pop_back();
+    }
+    if (spine.empty()) {
+        return -1;
+    }
+    update(spine.front());
+    return spine.front();
+}
+
+void SelectionSequence::split(int node, unsigned int count, int &left, int &right) {
+    if (node < 0) {
+        left = right = -1;
+        return;
+    }
+    Node &current = _nodes[unsigned(node)];
+    const unsigned int leftSize = nodeSize(current.left);
+    if (count <= leftSize) {
+        split(current.left, count, left, _nodes[unsigned(node)].left);
+        right = node;
+    }
+    else {
+        split(current.right, count - leftSize - 1, _nodes[unsigned(node)].right, right);
+        left = node;
+    }
+    update(node);
+}
+
+int SelectionSequence::merge(int left, int right) {
+    if (left < 0) {
+        return right;
+    }
+    if (right < 0) {
+        return left;
+    }
+    if (_nodes[unsigned(left)].priority > _nodes[unsigned(right)].priority) {
+        _nodes[unsigned(left)].right = merge(_nodes[unsigned(left)].right, right);
+        update(left);
+        return left;
+    }
+    _nodes[unsigned(right)].left = merge(left, _nodes[unsigned(right)].left);
+    update(right);
+    return right;
+}
+
+void SelectionSequence::release(int node, std::vector<Item> &items) {
+    std::vector<int> stack;
+    while (node >= 0 || !stack.empty()) {
+        while (node >= 0) {
+            stack.push_back(node);
+            node = _nodes[unsigned(node)].left;
+        }
+        node = stack.back();
+        stack.pop_back();
+        Node &current = _nodes[unsigned(node)];
+        items.push_back(current.item);
+        current.item.alias = QString();
+        _freeNodes.push_back(node);
+        node = current.right;
+    }
+}
+
+int SelectionSequence::newNode(const Item &item) {
+    Node node;
+    node.item = item;
+    node.priority = nextPriority();
+    node.size = 1;
+    node.left = node.right = -1;
+    if (!_freeNodes.empty()) {
+        const int pos = _freeNodes.back();
+        _freeNodes.pop_back();
+        _nodes[unsigned(pos)] = node;
+        return pos;
+    }
+    _nodes.push_back(node);
+    return int(_nodes.size()) - 1;
+}
+
+void SelectionSequence::update(int node) {
+    Node &current = _nodes[unsigned(node)];
+    current.size = 1 + nodeSize(current.left) + nodeSize(current.right);
+}
+
+unsigned int SelectionSequence::nextPriority() {
+    // xorshift32
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 17;
+    _seed ^= _seed << 5;
+    return _seed;
+}
+
+}
@@ -0,0 +1,100 @@
+#ifndef SELECTIONSEQUENCE_H
+#define SELECTIONSEQUENCE_H
+
+#include <vector>
+#include <QString>
+
+namespace Engine
+{
+
+/*
+ * SelectionSequence is the ordered list of the selected items, kept as an implicit treap: a
+ * binary tree in row order where each node knows the size of its subtree, so the row of a node
+ * is never stored. Random priorities keep the tree balanced on average. Finding a row costs
+ * O(log N), and inserting, taking out or moving a block of rows splits and merges the tree in
+ * O(log N) on top of the items inserted or taken out, wherever the rows are.
+ *
+ * Nodes are kept in a pool and linked by their position in it. The nodes which are freed are
+ * reused by the next insertion.
+*/
+class SelectionSequence {
+
+public:
+    // A selected item: its full list index and its alias
+    struct Item {
+        unsigned int index;
+        QString alias;
+    };
+
+public:
+    SelectionSequence();
+    ~SelectionSequence() { ; }
+    // Return the number of items
+    unsigned int size() const { return nodeSize(_root); }
+    bool empty() const { return _root < 0; }
+    // Return the item at the row
+    const Item &at(unsigned int row) const { return _nodes[unsigned(find(row))].item; }
+    Item &at(unsigned int row) { return _nodes[unsigned(find(row))].item; }
+    // Insert the items in front of the row
+    void insert(unsigned int row, const std::vector<Item> &items);
+    // Take out the rows [first, last] and return their items
+    std::vector<Item> take(unsigned int first, unsigned int last);
+    // Move the rows [first, last] in front of the row, counted once they're taken out
+    void move(unsigned int first, unsigned int last, unsigned int row);
+    // Replace all the items
+    void assign(const std::vector<Item> &items);
+    void clear();
+    // Call a function for every item in the row order
+    template <typename Function>
+    void forEach(Function function) const;
+
+private:
+    struct Node {
+        Item item;
+        unsigned int priority;
+        unsigned int size;
+        int left;
+        int right;
+    };
+    // Return the node at the row
+    int find(unsigned int row) const;
+    // Build a tree of the items in O(n)
+    int build(const std::vector<Item> &items);
+    // Split a tree into its first count rows and the rest
+    void split(int node, unsigned int count, int &left, int &right);
+    // Merge two trees, all the rows of left go first
+    int merge(int left, int right);
+    // Append the items of a tree to the list and free its nodes
+    void release(int node, std::vector<Item> &items);
+    int newNode(const Item &item);
+    unsigned int nodeSize(int node) const { return (node < 0) ? 0 : _nodes[unsigned(node)].size; }
+    void update(int node);
+    unsigned int nextPriority();
+
+private:
+    std::vector<Node> _nodes;
+    std::vector<int> _freeNodes;
+    int _root = -1;
+    unsigned int _seed = 2463534242u;
+};
+
+template <typename Function>
+void SelectionSequence::forEach(Function function) const {
+    // In-order walk with an explicit stack of the left spine
+    std::vector<int> stack;
+    int node = _root;
+    while (node >= 0 || !stack.empty()) {
+        while (node >= 0) {
+            stack.push_back(node);
+            node = _nodes[unsigned(node)].left;
+        }
+        node = stack.back();
+        stack.pop_back();
+        function(_nodes[unsigned(node)].item);
+        node = _nodes[unsigned(node)].right;
+    }
+}
+
+}
+
+#endif // SELECTIONSEQUENCE_H
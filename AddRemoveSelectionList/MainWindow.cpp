@@ -2,9 +2,12 @@
 #include "ui_MainWindow.h"
 #include <QStringList>
 #include <vector>
+#include <QThread>
 #include <QFile>
-#include <QTextStream>
 #include <QDebug>
+#include <QMessageBox>
+#include <Util/CatalogCsvReader.h>
+#include <Engine/SelectionJournal.h>
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -13,15 +16,28 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->setupUi(this);    
     ui->_addRemoveWidget->setFullListCheckbox(false);
     ui->_addRemoveWidget->setValidNameCheck(true);    
-    QStringList list;
-    QStringList tooltip;
-    std::vector<unsigned int> index;
-    readcsv(list,tooltip,index);
-    ui->_addRemoveWidget->setFullList(list,tooltip,index);
+    // The second column of the catalog is the category
+    ui->_addRemoveWidget->setViewsFromTooltips(true);
+    _catalogReloadTimer.setSingleShot(true);
+    _catalogReloadTimer.setInterval(500);
+    connect(&_catalogWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::onCatalogFileChanged);
+    connect(&_catalogReloadTimer, &QTimer::timeout, this, &MainWindow::reloadCatalog);
+    readCatalog("../foodlist.csv");
 }
 
 MainWindow::~MainWindow()
 {
+    // The reader is stopped and its thread joined before the widget goes away, so no chunk is
+    // handed to it while it's destroyed
+    if (_catalogReader) {
+        _catalogReader->cancel();
+    }
+    for (const QPointer<QThread> &thread : _catalogThreads) {
+        if (thread) {
+            thread->quit();
+            thread->wait();
+        }
+    }
     delete ui;
 }
 
@@ -30,22 +46,98 @@ void MainWindow::on_pushButton_clicked()
     qDebug() << "Something is happening!";
 }
 
-void MainWindow::readcsv(QStringList &list, QStringList &tooltip, std::vector<unsigned int> &index) {
-    QFile fp ("../foodlist.csv");
-    if(fp.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream textIn(&fp);
-        QString lineStr;
-        unsigned int idx = 0;
-        while (textIn.readLineInto(&lineStr)) {
-            QStringList strList = lineStr.split(",");
-            list << strList.at(0);
-            tooltip << strList.at(1);
-            if (strList.at(2) == QString("1")) {
-                index.push_back(idx);
-            }
-            idx++;
-        }
+/*
+ * The catalog is read on a worker thread and handed to the widget chunk by chunk, so the
+ * window is usable as soon as the first chunk arrives. The thread quits when the reader
+ * finishes and both are deleted once the thread has stopped.
+*/
+void MainWindow::readCatalog(const QString &filename) {
+    QThread *thread = new QThread();
+    Util::CatalogCsvReader *reader = new Util::CatalogCsvReader(filename);
+    reader->moveToThread(thread);
+    connect(thread, &QThread::started, reader, &Util::CatalogCsvReader::process);
+    connect(reader, &Util::CatalogCsvReader::chunkRead, this, &MainWindow::onCatalogChunkRead);
+    connect(reader, &Util::CatalogCsvReader::finished, this, &MainWindow::onCatalogRead);
+    connect(reader, &Util::CatalogCsvReader::finished, thread, &QThread::quit);
+    connect(thread, &QThread::finished, reader, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    _catalogReader = reader;
+    _catalogFile = filename;
+    _catalogThreads.removeAll(QPointer<QThread>()); // The threads already deleted
+    _catalogThreads << thread;
+    thread->start();
+}
+
+void MainWindow::onCatalogChunkRead(const QStringList &names, const QStringList &tooltips, const QVector<unsigned int> &shortListIndex) {
+    if (_reloading) {
+        _reloadNames << names;
+        _reloadTooltips << tooltips;
+        _reloadShortListIndex.insert(_reloadShortListIndex.end(), shortListIndex.begin(), shortListIndex.end());
+        return;
+    }
+    std::vector<unsigned int> index(shortListIndex.begin(), shortListIndex.end());
+    ui->_addRemoveWidget->appendFullList(names, tooltips, index);
+}
+
+void MainWindow::onCatalogRead(int status) {
+    _catalogReader = nullptr;
+    const bool reloaded = _reloading;
+    _reloading = false;
+    if (status == Util::CatalogCsvReader::FileError) {
+        QMessageBox::critical(this, "Error", "Failed to read the catalog " + _catalogFile + "!");
+    }
+    else if (!reloaded) {
+        openJournal();
+    }
+    else if (status == Util::CatalogCsvReader::NoError) {
+        ui->_addRemoveWidget->reloadFullList(_reloadNames, _reloadTooltips, _reloadShortListIndex);
     }
-    fp.close();
+    _reloadNames.clear();
+    _reloadTooltips.clear();
+    _reloadShortListIndex.clear();
+    // A file which is saved by replacing it is dropped from the watcher
+    if (!_catalogWatcher.files().contains(_catalogFile)) {
+        _catalogWatcher.addPath(_catalogFile);
+    }
+}
+
+void MainWindow::onCatalogFileChanged() {
+    _catalogReloadTimer.start();
+}
+
+/*
+ * The changed catalog is read the same way as the first time, but kept whole, so the widget
+ * can match it against the current one and keep the selection. A reload waits for a reading
+ * in progress, or for the file to be back if it was replaced.
+*/
+void MainWindow::reloadCatalog() {
+    if (_catalogReader || !QFile::exists(_catalogFile)) {
+        _catalogReloadTimer.start();
+        return;
+    }
+    _reloading = true;
+    readCatalog(_catalogFile);
 }
 
+/*
+ * Journaling is turned on by ADDREMOVESELECTION_JOURNAL. The journal refers to the rows of the
+ * catalog, so it's recovered only once the whole catalog has been read.
+*/
+void MainWindow::openJournal() {
+    QString filename = QString::fromLocal8Bit(qgetenv("ADDREMOVESELECTION_JOURNAL"));
+    if (filename.isEmpty()) {
+        return;
+    }
+    int status = (QFile::exists(filename)) ? ui->_addRemoveWidget->recoverJournal(filename)
+                                           : ui->_addRemoveWidget->setJournalFile(filename);
+    if (status == Engine::SelectionJournal::FormatError) {
+        QMessageBox::warning(this, "Journal", "The journal " + filename + " is damaged, the recovered selection may be incomplete.");
+    }
+    else if (status == Engine::SelectionJournal::CatalogChanged) {
+        QMessageBox::warning(this, "Journal", "The catalog changed since the journal " + filename + " was written, only its last "
+                             "saved selection is recovered. The journal is kept as " + Engine::SelectionJournal::backupFilename(filename) + ".");
+    }
+    else if (status != Engine::SelectionJournal::NoError) {
+        QMessageBox::warning(this, "Journal", "Failed to open the journal " + filename + "! The selection isn't journaled.");
+    }
+}
@@ -4,6 +4,15 @@
 #include <QMainWindow>
 #include <QStringList>
 #include <vector>
+#include <QVector>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QPointer>
+#include <QThread>
+
+namespace Util {
+class CatalogCsvReader;
+}
 
 namespace Ui {
 class MainWindow;
@@ -19,10 +28,30 @@ public:
 
 private slots:
     void on_pushButton_clicked();
+    void onCatalogChunkRead(const QStringList &names, const QStringList &tooltips, const QVector<unsigned int> &shortListIndex);
+    void onCatalogRead(int status);
+    void onCatalogFileChanged();
+    void reloadCatalog();
 
 private:
     Ui::MainWindow *ui;
-    void readcsv(QStringList &list, QStringList & tooltip, std::vector<unsigned int> &index);
+    Util::CatalogCsvReader *_catalogReader = nullptr;
+    // Threads of the catalog readers which may still be running. They're waited for when the
+    // window is destroyed.
+    QList<QPointer<QThread>> _catalogThreads;
+    QString _catalogFile;
+    // The catalog file is watched, and read again once the writes have settled
+    QFileSystemWatcher _catalogWatcher;
+    QTimer _catalogReloadTimer;
+    // A catalog being read again is kept whole until it's complete, then the widget reloads it
+    bool _reloading = false;
+    QStringList _reloadNames;
+    QStringList _reloadTooltips;
+    std::vector<unsigned int> _reloadShortListIndex;
+    // Read the catalog in the background and feed it to the widget
+    void readCatalog(const QString &filename);
+    // Recover the selection from the journal file, if journaling is turned on
+    void openJournal();
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,180 @@
+#include <QtTest>
+#include <random>
+#include <set>
+#include <vector>
+#include <Engine/IndexSet.h>
+
+using Engine::IndexSet;
+using Engine::IndexBitmap;
+
+/*
+ * Each kind of chunk is made from its own shape of indexes: a few scattered ones (array), more
+ * than MaxArraySize scattered ones (bitmap) and long ranges (runs). The set is compared with a
+ * std::set which gets the same changes.
+*/
+class tst_IndexSet : public QObject {
+    Q_OBJECT
+
+private slots:
+    void containers_data();
+    void containers();
+    void insertAndRemove();
+    void growAndShrink();
+    void editRuns();
+    void clearFrom();
+
+private:
+    static std::vector<unsigned int> sorted(const std::set<unsigned int> &indexes);
+    static void compare(const IndexSet &set, const std::set<unsigned int> &expected, unsigned int end);
+};
+
+std::vector<unsigned int> tst_IndexSet::sorted(const std::set<unsigned int> &indexes) {
+    return std::vector<unsigned int>(indexes.begin(), indexes.end());
+}
+
+// Compare the set with the expected indexes, and every lookup below end
+void tst_IndexSet::compare(const IndexSet &set, const std::set<unsigned int> &expected, unsigned int end) {
+    QCOMPARE(set.size(), unsigned(expected.size()));
+    QCOMPARE(set.isEmpty(), expected.empty());
+    QCOMPARE(set.toIndex(), sorted(expected));
+    for (unsigned int idx = 0 ; idx < end ; ++idx) {
+        QCOMPARE(set.contains(idx), expected.count(idx) > 0);
+    }
+}
+
+void tst_IndexSet::containers_data() {
+    QTest::addColumn<QString>("shape");
+
+    QTest::newRow("array") << QString("array");
+    QTest::newRow("bitmap") << QString("bitmap");
+    QTest::newRow("runs") << QString("runs");
+    QTest::newRow("mixed chunks") << QString("mixed");
+}
+
+void tst_IndexSet::containers() {
+    QFETCH(QString, shape);
+    std::mt19937 random(7);
+    std::set<unsigned int> expected;
+    if (shape == "array" || shape == "mixed") {
+        for (int count = 0 ; count < 1000 ; ++count) {
+            expected.insert(random() % 65536);
+        }
+    }
+    if (shape == "bitmap" || shape == "mixed") {
+        for (int count = 0 ; count < 20000 ; ++count) {
+            expected.insert(65536 + random() % 65536);
+        }
+    }
+    if (shape == "runs" || shape == "mixed") {
+        for (unsigned int first = 3 * 65536 + 10 ; first < 5 * 65536 ; first += 5000) {
+            for (unsigned int idx = first ; idx < first + 3000 ; ++idx) {
+                expected.insert(idx);
+            }
+        }
+    }
+    IndexSet set;
+    set.assign(sorted(expected));
+    compare(set, expected, 6 * 65536);
+    // Packing the chunks again doesn't change the indexes
+    set.optimize();
+    compare(set, expected, 6 * 65536);
+    // Same indexes one by one
+    IndexSet inserted;
+    for (const unsigned int &idx : expected) {
+        QVERIFY(inserted.insert(idx));
+    }
+    QVERIFY(!inserted.insert(*expected.begin()));
+    QCOMPARE(inserted.toIndex(), set.toIndex());
+    set.clear();
+    compare(set, std::set<unsigned int>(), 65536);
+}
+
+void tst_IndexSet::insertAndRemove() {
+    std::mt19937 random(42);
+    IndexSet set;
+    std::set<unsigned int> expected;
+    const unsigned int end = 4 * 65536;
+    for (int step = 0 ; step < 50000 ; ++step) {
+        const unsigned int idx = random() % end;
+        if (random() % 3 == 0) {
+            QCOMPARE(set.remove(idx), expected.erase(idx) > 0);
+        }
+        else {
+            QCOMPARE(set.insert(idx), expected.insert(idx).second);
+        }
+    }
+    compare(set, expected, end);
+}
+
+// A chunk becomes a bitmap past MaxArraySize indexes and an array again below it
+void tst_IndexSet::growAndShrink() {
+    IndexSet set;
+    std::set<unsigned int> expected;
+    for (unsigned int idx = 0 ; idx < 2 * IndexSet::MaxArraySize ; ++idx) {
+        set.insert(idx * 7);
+        expected.insert(idx * 7);
+    }
+    compare(set, expected, 65536);
+    for (unsigned int idx = 0 ; idx < 2 * IndexSet::MaxArraySize - 10 ; ++idx) {
+        QVERIFY(set.remove(idx * 7));
+        expected.erase(idx * 7);
+    }
+    compare(set, expected, 65536);
+    // The last chunk goes away once it's empty
+    for (const unsigned int &idx : sorted(expected)) {
+        QVERIFY(set.remove(idx));
+    }
+    QVERIFY(set.isEmpty());
+    QVERIFY(!set.remove(7));
+}
+
+// A chunk of runs is unpacked when it's changed
+void tst_IndexSet::editRuns() {
+    std::vector<unsigned int> range;
+    for (unsigned int idx = 100 ; idx < 60000 ; ++idx) {
+        range.push_back(idx);
+    }
+    IndexSet set;
+    set.assign(range);
+    std::set<unsigned int> expected(range.begin(), range.end());
+    QVERIFY(set.remove(30000));
+    expected.erase(30000);
+    QVERIFY(set.insert(99));
+    expected.insert(99);
+    QVERIFY(!set.insert(100));
+    QVERIFY(set.insert(70000));
+    expected.insert(70000);
+    compare(set, expected, 2 * 65536);
+    set.optimize();
+    compare(set, expected, 2 * 65536);
+}
+
+void tst_IndexSet::clearFrom() {
+    std::mt19937 random(3);
+    const unsigned int size = 5 * 65536 + 123;
+    std::set<unsigned int> expected;
+    for (int count = 0 ; count < 500 ; ++count) {
+        expected.insert(random() % 65536);
+    }
+    for (int count = 0 ; count < 30000 ; ++count) {
+        expected.insert(65536 + random() % 65536);
+    }
+    for (unsigned int idx = 2 * 65536 + 5 ; idx < 4 * 65536 + 77 ; ++idx) {
+        expected.insert(idx);
+    }
+    for (unsigned int idx = size - 50 ; idx < size ; ++idx) {
+        expected.insert(idx);
+    }
+    IndexSet set;
+    set.assign(sorted(expected));
+    IndexBitmap bits(size, true);
+    set.clearFrom(bits);
+    QCOMPARE(bits.count(), size - unsigned(expected.size()));
+    for (unsigned int idx = 0 ; idx < size ; ++idx) {
+        QCOMPARE(bits.test(idx), expected.count(idx) == 0);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_IndexSet)
+
+#include "tst_IndexSet.moc"
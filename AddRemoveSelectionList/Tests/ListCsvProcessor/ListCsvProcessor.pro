@@ -0,0 +1,13 @@
+QT       = core testlib
+
+QMAKE_CXXFLAGS += -std=c++11
+CONFIG += c++11 console testcase
+CONFIG -= debug_and_release app_bundle
+TARGET = tst_ListCsvProcessor
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../Engine/SelectionEngine.pri)
+
+SOURCES += tst_ListCsvProcessor.cpp
@@ -0,0 +1,106 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <Util/ListCsvProcessor.h>
+
+using Util::ListCsvProcessor;
+
+/*
+ * Every file is read in both modes, which must agree on the status and the lists. A file which
+ * isn't valid leaves the lists as they were.
+*/
+class tst_ListCsvProcessor : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void readModes_data();
+    void readModes();
+    void writeAndRead();
+
+private:
+    QString writeFile(const QByteArray &content);
+
+private:
+    QTemporaryDir _dir;
+    int _fileCount = 0;
+};
+
+void tst_ListCsvProcessor::initTestCase() {
+    QVERIFY(_dir.isValid());
+}
+
+QString tst_ListCsvProcessor::writeFile(const QByteArray &content) {
+    QString filename = _dir.filePath(QString("list%1.csv").arg(_fileCount++));
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size()) {
+        return QString();
+    }
+    return filename;
+}
+
+void tst_ListCsvProcessor::readModes_data() {
+    QTest::addColumn<QByteArray>("content");
+    QTest::addColumn<int>("status");
+    QTest::addColumn<QStringList>("rawList");
+    QTest::addColumn<QStringList>("aliasList");
+
+    QTest::newRow("empty file") << QByteArray() << int(ListCsvProcessor::NoError) << QStringList() << QStringList();
+    QTest::newRow("lines") << QByteArray("Apple,apple\nRice,rice\n") << int(ListCsvProcessor::NoError)
+                           << (QStringList() << "Apple" << "Rice") << (QStringList() << "apple" << "rice");
+    QTest::newRow("no last newline") << QByteArray("Apple,apple\nRice,rice") << int(ListCsvProcessor::NoError)
+                                     << (QStringList() << "Apple" << "Rice") << (QStringList() << "apple" << "rice");
+    QTest::newRow("crlf") << QByteArray("Apple,apple\r\nRice,rice\r\n") << int(ListCsvProcessor::NoError)
+                          << (QStringList() << "Apple" << "Rice") << (QStringList() << "apple" << "rice");
+    QTest::newRow("empty lines") << QByteArray("\nApple,apple\n\r\n\nRice,rice\n\n") << int(ListCsvProcessor::NoError)
+                                 << (QStringList() << "Apple" << "Rice") << (QStringList() << "apple" << "rice");
+    QTest::newRow("empty fields") << QByteArray(",\nApple,\n") << int(ListCsvProcessor::NoError)
+                                  << (QStringList() << "" << "Apple") << (QStringList() << "" << "");
+    QTest::newRow("byte order mark") << QByteArray("\xEF\xBB\xBFPomme,pomme\n") << int(ListCsvProcessor::NoError)
+                                     << (QStringList() << "Pomme") << (QStringList() << "pomme");
+    QTest::newRow("utf-8") << QByteArray("Cr\xC3\xA8me,cr\xC3\xA8me\n") << int(ListCsvProcessor::NoError)
+                           << (QStringList() << QString::fromUtf8("Cr\xC3\xA8me")) << (QStringList() << QString::fromUtf8("cr\xC3\xA8me"));
+    QTest::newRow("no comma") << QByteArray("Apple,apple\nRice\n") << int(ListCsvProcessor::FormatError)
+                              << QStringList() << QStringList();
+    QTest::newRow("two commas") << QByteArray("Apple,apple\nRice,rice,more\n") << int(ListCsvProcessor::FormatError)
+                                << QStringList() << QStringList();
+    QTest::newRow("blank line") << QByteArray("Apple,apple\n \n") << int(ListCsvProcessor::FormatError)
+                                << QStringList() << QStringList();
+}
+
+void tst_ListCsvProcessor::readModes() {
+    QFETCH(QByteArray, content);
+    QFETCH(int, status);
+    QFETCH(QStringList, rawList);
+    QFETCH(QStringList, aliasList);
+    const QString filename = writeFile(content);
+    QVERIFY(!filename.isEmpty());
+    // The items read are appended to the lists
+    const QStringList before = QStringList() << "Before";
+    for (ListCsvProcessor::ReadMode mode : {ListCsvProcessor::MappedMode, ListCsvProcessor::StreamMode}) {
+        ListCsvProcessor processor(filename);
+        processor.setReadMode(mode);
+        QStringList sList_raw = before;
+        QStringList sList_alias = before;
+        QCOMPARE(processor.getLists(sList_raw, sList_alias), status);
+        QCOMPARE(sList_raw, before + rawList);
+        QCOMPARE(sList_alias, before + aliasList);
+        QCOMPARE(processor.isValid(), status == ListCsvProcessor::NoError);
+    }
+}
+
+void tst_ListCsvProcessor::writeAndRead() {
+    const QString filename = _dir.filePath("written.csv");
+    const QStringList rawList = QStringList() << "Apple" << "Rice" << QString::fromUtf8("Cr\xC3\xA8me");
+    const QStringList aliasList = QStringList() << "apple" << "" << "creme";
+    QCOMPARE(ListCsvProcessor::write(filename, rawList, aliasList), int(ListCsvProcessor::NoError));
+    QStringList sList_raw, sList_alias;
+    QCOMPARE(ListCsvProcessor::read(filename, sList_raw, sList_alias), int(ListCsvProcessor::NoError));
+    QCOMPARE(sList_raw, rawList);
+    QCOMPARE(sList_alias, aliasList);
+    QCOMPARE(ListCsvProcessor::read(_dir.filePath("missing.csv"), sList_raw, sList_alias), int(ListCsvProcessor::FileError));
+}
+
+QTEST_APPLESS_MAIN(tst_ListCsvProcessor)
+
+#include "tst_ListCsvProcessor.moc"
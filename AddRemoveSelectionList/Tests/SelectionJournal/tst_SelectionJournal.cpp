@@ -0,0 +1,218 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <Engine/SelectionEngine.h>
+#include <Engine/SelectionJournal.h>
+
+using Engine::SelectionEngine;
+using Engine::SelectionJournal;
+
+/*
+ * A selection is edited with a journal open, then the journal is recovered by another engine
+ * over the same catalog, which must end up with the same selected items and aliases.
+*/
+class tst_SelectionJournal : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void recoverEdits();
+    void corruptTail_data();
+    void corruptTail();
+    void corruptMiddle();
+    void compaction();
+    void catalogChanged();
+    void missingFile();
+
+private:
+    static QStringList catalogNames(int size);
+    // Add, insert, remove, move and rename items of the engine
+    static void edit(SelectionEngine &engine);
+    // Return the selection of the engine recovered by a new engine over the catalog
+    static int recover(const QString &filename, const QStringList &fullList, std::vector<unsigned int> &index, QStringList &aliasList);
+
+private:
+    QTemporaryDir _dir;
+};
+
+void tst_SelectionJournal::initTestCase() {
+    QVERIFY(_dir.isValid());
+}
+
+QStringList tst_SelectionJournal::catalogNames(int size) {
+    QStringList names;
+    for (int idx = 0 ; idx < size ; ++idx) {
+        names << QString("item_%1").arg(idx);
+    }
+    return names;
+}
+
+void tst_SelectionJournal::edit(SelectionEngine &engine) {
+    engine.appendItems({1, 2, 3, 4, 5, 6});
+    engine.insertItems(0, {10, 11}, QStringList() << "ten" << "eleven");
+    engine.takeItems({std::make_pair(3, 4)});
+    engine.moveItems({0, 1}, {4, 5});
+    engine.renameItem(2, "renamed");
+}
+
+int tst_SelectionJournal::recover(const QString &filename, const QStringList &fullList, std::vector<unsigned int> &index, QStringList &aliasList) {
+    SelectionEngine engine;
+    engine.setFullList(fullList);
+    SelectionJournal journal(&engine);
+    const int status = journal.recover(filename);
+    index = engine.selectedIndex();
+    aliasList = engine.selectedAliasList();
+    return status;
+}
+
+void tst_SelectionJournal::recoverEdits() {
+    const QString filename = _dir.filePath("edits.arsj");
+    SelectionEngine engine;
+    engine.setFullList(catalogNames(100));
+    SelectionJournal journal(&engine);
+    QCOMPARE(journal.open(filename), int(SelectionJournal::NoError));
+    edit(engine);
+    QVERIFY(journal.recordCount() > 0);
+    QCOMPARE(journal.status(), int(SelectionJournal::NoError));
+    journal.close();
+    std::vector<unsigned int> index;
+    QStringList aliasList;
+    QCOMPARE(recover(filename, catalogNames(100), index, aliasList), int(SelectionJournal::NoError));
+    QCOMPARE(index, engine.selectedIndex());
+    QCOMPARE(aliasList, engine.selectedAliasList());
+    // Nothing was lost, so the journal isn't kept aside
+    QVERIFY(!QFile::exists(SelectionJournal::backupFilename(filename)));
+}
+
+void tst_SelectionJournal::corruptTail_data() {
+    QTest::addColumn<bool>("truncate");
+
+    QTest::newRow("record cut short") << true;
+    QTest::newRow("bad checksum") << false;
+}
+
+// The last record is lost, the ones before it are replayed
+void tst_SelectionJournal::corruptTail() {
+    QFETCH(bool, truncate);
+    const QString filename = _dir.filePath("corrupt.arsj");
+    SelectionEngine engine;
+    engine.setFullList(catalogNames(100));
+    SelectionJournal journal(&engine);
+    QCOMPARE(journal.open(filename), int(SelectionJournal::NoError));
+    edit(engine);
+    const std::vector<unsigned int> expectedIndex = engine.selectedIndex();
+    const QStringList expectedAliasList = engine.selectedAliasList();
+    engine.renameItem(0, "lost");
+    journal.close();
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    if (truncate) {
+        QVERIFY(file.resize(file.size() - 2));
+    }
+    else {
+        QVERIFY(file.seek(file.size() - 1));
+        QVERIFY(file.write("#", 1) == 1);
+    }
+    file.close();
+    std::vector<unsigned int> index;
+    QStringList aliasList;
+    QCOMPARE(recover(filename, catalogNames(100), index, aliasList), int(SelectionJournal::NoError));
+    QCOMPARE(index, expectedIndex);
+    QCOMPARE(aliasList, expectedAliasList);
+}
+
+// A damaged record with records behind it isn't taken for a crash: the records in front of it
+// are replayed, and the file is kept aside before it's compacted
+void tst_SelectionJournal::corruptMiddle() {
+    const QString filename = _dir.filePath("middle.arsj");
+    SelectionEngine engine;
+    engine.setFullList(catalogNames(100));
+    SelectionJournal journal(&engine);
+    QCOMPARE(journal.open(filename), int(SelectionJournal::NoError));
+    engine.appendItems({1, 2, 3});
+    const std::vector<unsigned int> expectedIndex = engine.selectedIndex();
+    const QStringList expectedAliasList = engine.selectedAliasList();
+    // The type of the next record
+    const qint64 damagedPos = QFile(filename).size() + 8;
+    engine.renameItem(0, "damaged");
+    engine.appendItems({4, 5});
+    journal.close();
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(damagedPos));
+    QVERIFY(file.write("#", 1) == 1);
+    QVERIFY(file.seek(0));
+    const QByteArray content = file.readAll();
+    file.close();
+    std::vector<unsigned int> index;
+    QStringList aliasList;
+    QCOMPARE(recover(filename, catalogNames(100), index, aliasList), int(SelectionJournal::FormatError));
+    QCOMPARE(index, expectedIndex);
+    QCOMPARE(aliasList, expectedAliasList);
+    QFile backup(SelectionJournal::backupFilename(filename));
+    QVERIFY(backup.open(QIODevice::ReadOnly));
+    QCOMPARE(backup.readAll(), content);
+}
+
+void tst_SelectionJournal::compaction() {
+    const QString filename = _dir.filePath("compaction.arsj");
+    SelectionEngine engine;
+    engine.setFullList(catalogNames(100));
+    SelectionJournal journal(&engine);
+    QCOMPARE(journal.open(filename), int(SelectionJournal::NoError));
+    engine.appendItems({7, 8, 9});
+    const int nRename = SelectionJournal::MinCompactionRecords + 100;
+    for (int count = 0 ; count < nRename ; ++count) {
+        engine.renameItem(count % 3, QString("name_%1").arg(count));
+    }
+    // The file was rewritten as a snapshot once, then got the records after it
+    QVERIFY(journal.recordCount() < nRename);
+    QCOMPARE(journal.status(), int(SelectionJournal::NoError));
+    journal.close();
+    std::vector<unsigned int> index;
+    QStringList aliasList;
+    QCOMPARE(recover(filename, catalogNames(100), index, aliasList), int(SelectionJournal::NoError));
+    QCOMPARE(index, engine.selectedIndex());
+    QCOMPARE(aliasList, engine.selectedAliasList());
+}
+
+// The records don't fit another full list: the snapshot is matched by names, and the journal
+// is kept aside before it's compacted
+void tst_SelectionJournal::catalogChanged() {
+    const QString filename = _dir.filePath("changed.arsj");
+    SelectionEngine engine;
+    engine.setFullList(catalogNames(100));
+    engine.appendItems({20, 30});
+    SelectionJournal journal(&engine);
+    QCOMPARE(journal.open(filename), int(SelectionJournal::NoError));
+    edit(engine);
+    journal.close();
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray content = file.readAll();
+    file.close();
+    // Same names shifted by one row
+    const QStringList changedList = QStringList() << "new_item" << catalogNames(100);
+    std::vector<unsigned int> index;
+    QStringList aliasList;
+    QCOMPARE(recover(filename, changedList, index, aliasList), int(SelectionJournal::CatalogChanged));
+    QCOMPARE(index, std::vector<unsigned int>({21, 31}));
+    QFile backup(SelectionJournal::backupFilename(filename));
+    QVERIFY(backup.open(QIODevice::ReadOnly));
+    QCOMPARE(backup.readAll(), content);
+    // The journal was compacted, so it's recovered without changes from now on
+    QCOMPARE(recover(filename, changedList, index, aliasList), int(SelectionJournal::NoError));
+    QCOMPARE(index, std::vector<unsigned int>({21, 31}));
+}
+
+void tst_SelectionJournal::missingFile() {
+    SelectionEngine engine;
+    engine.setFullList(catalogNames(10));
+    SelectionJournal journal(&engine);
+    QCOMPARE(journal.recover(_dir.filePath("missing.arsj")), int(SelectionJournal::FileError));
+    QVERIFY(!journal.isOpen());
+}
+
+QTEST_APPLESS_MAIN(tst_SelectionJournal)
+
+#include "tst_SelectionJournal.moc"
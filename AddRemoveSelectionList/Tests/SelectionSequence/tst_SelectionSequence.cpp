@@ -0,0 +1,151 @@
+#include <QtTest>
+#include <random>
+#include <vector>
+#include <Engine/SelectionSequence.h>
+
+using Engine::SelectionSequence;
+
+/*
+ * The treap is compared with a plain vector which gets the same edits. The random edits use a
+ * fixed seed, so a failure is the same on every run.
+*/
+class tst_SelectionSequence : public QObject {
+    Q_OBJECT
+
+private slots:
+    void insertAndTake();
+    void moves();
+    void assign();
+    void randomEdits();
+
+private:
+    static std::vector<SelectionSequence::Item> makeItems(unsigned int first, unsigned int count);
+    static std::vector<unsigned int> indexes(const SelectionSequence &sequence);
+    static std::vector<unsigned int> indexes(const std::vector<SelectionSequence::Item> &items);
+    static void moveItems(std::vector<SelectionSequence::Item> &items, unsigned int first, unsigned int last, unsigned int row);
+};
+
+std::vector<SelectionSequence::Item> tst_SelectionSequence::makeItems(unsigned int first, unsigned int count) {
+    std::vector<SelectionSequence::Item> items(count);
+    for (unsigned int pos = 0 ; pos < count ; ++pos) {
+        items[pos].index = first + pos;
+        items[pos].alias = QString("item_%1").arg(first + pos);
+    }
+    return items;
+}
+
+std::vector<unsigned int> tst_SelectionSequence::indexes(const SelectionSequence &sequence) {
+    std::vector<unsigned int> index;
+    sequence.forEach([&index](const SelectionSequence::Item &item) { index.push_back(item.index); });
+    return index;
+}
+
+std::vector<unsigned int> tst_SelectionSequence::indexes(const std::vector<SelectionSequence::Item> &items) {
+    std::vector<unsigned int> index;
+    for (const SelectionSequence::Item &item : items) {
+        index.push_back(item.index);
+    }
+    return index;
+}
+
+// Same as SelectionSequence::move(), the row is counted once the rows are taken out
+void tst_SelectionSequence::moveItems(std::vector<SelectionSequence::Item> &items, unsigned int first, unsigned int last, unsigned int row) {
+    std::vector<SelectionSequence::Item> moved(items.begin() + first, items.begin() + last + 1);
+    items.erase(items.begin() + first, items.begin() + last + 1);
+    items.insert(items.begin() + row, moved.begin(), moved.end());
+}
+
+void tst_SelectionSequence::insertAndTake() {
+    SelectionSequence sequence;
+    QVERIFY(sequence.empty());
+    sequence.insert(0, makeItems(0, 10));
+    sequence.insert(10, makeItems(20, 5));
+    sequence.insert(5, makeItems(100, 3));
+    QCOMPARE(sequence.size(), 18u);
+    QCOMPARE(sequence.at(5).index, 100u);
+    QCOMPARE(sequence.at(7).alias, QString("item_102"));
+    QCOMPARE(sequence.at(8).index, 5u);
+    QCOMPARE(sequence.at(17).index, 24u);
+    const std::vector<SelectionSequence::Item> taken = sequence.take(5, 7);
+    QCOMPARE(indexes(taken), indexes(makeItems(100, 3)));
+    std::vector<SelectionSequence::Item> expected = makeItems(0, 10);
+    const std::vector<SelectionSequence::Item> tail = makeItems(20, 5);
+    expected.insert(expected.end(), tail.begin(), tail.end());
+    QCOMPARE(indexes(sequence), indexes(expected));
+    // The freed nodes are reused
+    sequence.insert(0, makeItems(200, 3));
+    QCOMPARE(sequence.at(0).index, 200u);
+    QCOMPARE(sequence.size(), 18u);
+}
+
+void tst_SelectionSequence::moves() {
+    const unsigned int size = 20;
+    // (first, last, row) to the front, to the end, in the middle, single rows, and in place
+    const unsigned int moves[][3] = { {10, 14, 0}, {0, 4, 15}, {3, 6, 10}, {19, 19, 0}, {0, 0, 19}, {5, 9, 5} };
+    for (const auto &move : moves) {
+        SelectionSequence sequence;
+        sequence.assign(makeItems(0, size));
+        std::vector<SelectionSequence::Item> expected = makeItems(0, size);
+        sequence.move(move[0], move[1], move[2]);
+        moveItems(expected, move[0], move[1], move[2]);
+        QCOMPARE(indexes(sequence), indexes(expected));
+        for (unsigned int row = 0 ; row < size ; ++row) {
+            QCOMPARE(sequence.at(row).alias, expected.at(row).alias);
+        }
+    }
+}
+
+void tst_SelectionSequence::assign() {
+    SelectionSequence sequence;
+    sequence.insert(0, makeItems(0, 100));
+    sequence.assign(makeItems(1000, 50));
+    QCOMPARE(indexes(sequence), indexes(makeItems(1000, 50)));
+    sequence.assign(std::vector<SelectionSequence::Item>());
+    QVERIFY(sequence.empty());
+    sequence.clear();
+    QCOMPARE(sequence.size(), 0u);
+}
+
+void tst_SelectionSequence::randomEdits() {
+    std::mt19937 random(12345);
+    SelectionSequence sequence;
+    std::vector<SelectionSequence::Item> expected;
+    unsigned int nextIndex = 0;
+    for (int step = 0 ; step < 2000 ; ++step) {
+        const unsigned int size = unsigned(expected.size());
+        const unsigned int operation = (size == 0) ? 0 : random() % 3;
+        if (operation == 0) {
+            const unsigned int row = random() % (size + 1);
+            const std::vector<SelectionSequence::Item> items = makeItems(nextIndex, 1 + random() % 50);
+            nextIndex += unsigned(items.size());
+            sequence.insert(row, items);
+            expected.insert(expected.begin() + row, items.begin(), items.end());
+        }
+        else {
+            const unsigned int first = random() % size;
+            const unsigned int last = first + random() % std::min(size - first, 50u);
+            if (operation == 1 && size > 200) {
+                QCOMPARE(indexes(sequence.take(first, last)), indexes(std::vector<SelectionSequence::Item>(
+                                                                      expected.begin() + first, expected.begin() + last + 1)));
+                expected.erase(expected.begin() + first, expected.begin() + last + 1);
+            }
+            else {
+                const unsigned int row = random() % (size - (last - first));
+                sequence.move(first, last, row);
+                moveItems(expected, first, last, row);
+            }
+        }
+        QCOMPARE(sequence.size(), unsigned(expected.size()));
+        if (step % 100 == 0) {
+            QCOMPARE(indexes(sequence), indexes(expected));
+        }
+    }
+    QCOMPARE(indexes(sequence), indexes(expected));
+    for (unsigned int row = 0 ; row < sequence.size() ; ++row) {
+        QCOMPARE(sequence.at(row).index, expected.at(row).index);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_SelectionSequence)
+
+#include "tst_SelectionSequence.moc"
@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# Unit tests of the selection engine and the file utilities (Qt Test).
+# Build and run them all with:
+#   qmake Tests.pro && make check
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    ListCsvProcessor \
+    SelectionSequence \
+    IndexSet \
+    SelectionJournal
@@ -0,0 +1,152 @@
+#include "Catalog.h"
+#include "Trace.h"
+
+namespace Util
+{
+
+namespace
+{
+
+// Returned when there is no tooltip
+const QString EmptyTooltip;
+
+}
+
+Catalog::Catalog() {
+    clear();
+}
+
+Catalog::Catalog(const QStringList &names, const QStringList &tooltips) {
+    clear();
+    append(names, tooltips);
+}
+
+const QString &Catalog::tooltip(int idx) const {
+    if (!hasTooltips()) {
+        return EmptyTooltip;
+    }
+    return _tooltipDictionary.at(int(_tooltipCodes.at(idx)));
+}
+
+void Catalog::append(const QStringList &names, const QStringList &tooltips) {
+    TraceSpan span("Catalog::append");
+    span.setItems(names.size());
+    const bool keepTooltips = (tooltips.size() == names.size() && _tooltipCodes.size() == size());
+    // The arena and the vectors grow geometrically, so appending chunk by chunk stays linear
+    for (const QString &name : names) {
+        _nameArena.append(name);
+        _nameOffsets.append(_nameArena.size());
+    }
+    if (!keepTooltips) {
+        clearTooltips();
+        return;
+    }
+    for (const QString &tooltip : tooltips) {
+        _tooltipCodes.append(tooltipCodeOf(tooltip));
+    }
+}
+
+void Catalog::setTooltips(const QStringList &tooltips) {
+    clearTooltips();
+    if (tooltips.size() != size()) {
+        return;
+    }
+    _tooltipCodes.reserve(size());
+    for (const QString &tooltip : tooltips) {
+        _tooltipCodes.append(tooltipCodeOf(tooltip));
+    }
+}
+
+void Catalog::clear() {
+    _nameArena.clear();
+    _nameOffsets.clear();
+    _nameOffsets.append(0);
+    clearTooltips();
+}
+
+QStringList Catalog::names() const {
+    QStringList names;
+    names.reserve(size());
+    for (int idx = 0 ; idx < size() ; ++idx) {
+        names << name(idx);
+    }
+    return names;
+}
+
+QStringList Catalog::tooltips() const {
+    QStringList tooltips;
+    if (!hasTooltips()) {
+        return tooltips;
+    }
+    tooltips.reserve(size());
+    for (const quint32 &code : _tooltipCodes) {
+        tooltips << _tooltipDictionary.at(int(code));
+    }
+    return tooltips;
+}
+
+quint32 Catalog::tooltipCodeOf(const QString &tooltip) {
+    auto found = _tooltipCodeOf.constFind(tooltip);
+    if (found != _tooltipCodeOf.constEnd()) {
+        return found.value();
+    }
+    const quint32 code = quint32(_tooltipDictionary.size());
+    _tooltipDictionary << tooltip;
+    _tooltipCodeOf.insert(tooltip, code);
+    return code;
+}
+
+void Catalog::clearTooltips() {
+    _tooltipCodes.clear();
+    _tooltipDictionary.clear();
+    _tooltipCodeOf.clear();
+    // Code 0 is always the empty tooltip
+    tooltipCodeOf(QString());
+}
+
+/*
+ * A catalog which is read again usually differs by a few entries. The common head and tail are
+ * matched by comparing the names in place, and only the names in between are hashed. Entries
+ * sharing a name are chained in order, so the n-th occurrence is matched to the n-th one.
+*/
+std::vector<int> Catalog::indexIn(const Catalog &other) const {
+    TraceSpan span("Catalog::indexIn");
+    span.setItems(size());
+    const int nOld = size();
+    const int nNew = other.size();
+    std::vector<int> index(size_t(nOld), -1);
+    int head = 0;
+    while (head < nOld && head < nNew && nameRef(head) == other.nameRef(head)) {
+        index[size_t(head)] = head;
+        ++head;
+    }
+    int tail = 0;
+    while (tail < nOld - head && tail < nNew - head && nameRef(nOld - 1 - tail) == other.nameRef(nNew - 1 - tail)) {
+        index[size_t(nOld - 1 - tail)] = nNew - 1 - tail;
+        ++tail;
+    }
+    // First unmatched entry of each name in the other catalog, and the next one with the same name
+    QHash<QStringRef, int> firstOf;
+    firstOf.reserve(nNew - head - tail);
+    std::vector<int> nextOf(size_t(nNew - head - tail), -1);
+    for (int idx = nNew - tail - 1 ; idx >= head ; --idx) {
+        auto first = firstOf.find(other.nameRef(idx));
+        if (first != firstOf.end()) {
+            nextOf[size_t(idx - head)] = first.value();
+            first.value() = idx;
+        }
+        else {
+            firstOf.insert(other.nameRef(idx), idx);
+        }
+    }
+    for (int idx = head ; idx < nOld - tail ; ++idx) {
+        auto first = firstOf.find(nameRef(idx));
+        if (first != firstOf.end() && first.value() >= 0) {
+            index[size_t(idx)] = first.value();
+            first.value() = nextOf[size_t(first.value() - head)];
+        }
+    }
+    return index;
+}
+
+}
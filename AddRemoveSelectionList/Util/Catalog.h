@@ -0,0 +1,76 @@
+#ifndef Catalog_H
+#define Catalog_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringRef>
+#include <QVector>
+#include <QHash>
+#include <vector>
+
+namespace Util
+{
+
+/*
+ * Catalog stores the full list and its tooltips in a compact form. The names are kept back to
+ * back in one UTF-16 arena and found by their offsets, instead of one QString per entry. The
+ * tooltips repeat a few values (e.g. categories), so each distinct tooltip is stored once in a
+ * dictionary and every entry only keeps its code. Code 0 is the empty tooltip.
+ *
+ * All the members are implicitly shared Qt containers: copying a catalog is cheap, and a copy
+ * can be read on another thread while the original keeps growing.
+*/
+class Catalog {
+
+public:
+    Catalog();
+    // Build a catalog from a list of names and their tooltips (same size, otherwise ignored)
+    explicit Catalog(const QStringList &names, const QStringList &tooltips = QStringList());
+    ~Catalog() { ; }
+    // Return the number of entries
+    int size() const { return _nameOffsets.size() - 1; }
+    bool isEmpty() const { return size() == 0; }
+    // Return the name of an entry. It's copied out of the arena.
+    QString name(int idx) const { return _nameArena.mid(_nameOffsets.at(idx), nameLength(idx)); }
+    // Return the name of an entry without copying it. It's valid while this catalog isn't changed.
+    QStringRef nameRef(int idx) const { return QStringRef(&_nameArena, _nameOffsets.at(idx), nameLength(idx)); }
+    // Return true if every entry has a tooltip code
+    bool hasTooltips() const { return !isEmpty() && _tooltipCodes.size() == size(); }
+    // Return the tooltip of an entry, an empty string if there are no tooltips
+    const QString &tooltip(int idx) const;
+    // Return the tooltip code of an entry, 0 if there are no tooltips
+    int tooltipCode(int idx) const { return hasTooltips() ? int(_tooltipCodes.at(idx)) : 0; }
+    // Return the distinct tooltips. The position of a tooltip is its code.
+    const QStringList &tooltipDictionary() const { return _tooltipDictionary; }
+    // Append entries. The tooltips are kept only if they're the same size as the names and the
+    // catalog had tooltips for all its entries so far.
+    void append(const QStringList &names, const QStringList &tooltips = QStringList());
+    // Replace the tooltips (same size as the catalog, otherwise they're removed)
+    void setTooltips(const QStringList &tooltips);
+    // Remove all the entries
+    void clear();
+    // Return the names / the tooltips as lists. Every entry is copied.
+    QStringList names() const;
+    QStringList tooltips() const;
+    // Return the index in another catalog of each entry, matched by name, -1 if it isn't there.
+    // Entries sharing a name are matched in order.
+    std::vector<int> indexIn(const Catalog &other) const;
+
+private:
+    int nameLength(int idx) const { return _nameOffsets.at(idx + 1) - _nameOffsets.at(idx); }
+    // Return the code of a tooltip, adding it to the dictionary if it's new
+    quint32 tooltipCodeOf(const QString &tooltip);
+    void clearTooltips();
+
+private:
+    // The names back to back, and the offset of each name with the end of the arena last
+    QString _nameArena;
+    QVector<int> _nameOffsets;
+    QStringList _tooltipDictionary;
+    QHash<QString, quint32> _tooltipCodeOf;
+    QVector<quint32> _tooltipCodes;
+};
+
+}
+
+#endif // Catalog_H
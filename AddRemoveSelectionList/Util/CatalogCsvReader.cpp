@@ -0,0 +1,60 @@
+#include "CatalogCsvReader.h"
+#include "Trace.h"
+#include <QFile>
+#include <QTextStream>
+
+namespace Util
+{
+
+CatalogCsvReader::CatalogCsvReader(const QString &filename, QObject *parent) :
+    QObject(parent), _filename(filename), _cancelled(false) {
+
+}
+
+int CatalogCsvReader::run() {
+    TraceSpan span("CatalogCsvReader::run");
+    QFile fp(_filename);
+    if (!fp.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return FileError;
+    }
+    QTextStream textIn(&fp);
+    QString lineStr;
+    QStringList names, tooltips;
+    QVector<unsigned int> shortListIndex;
+    unsigned int idx = 0;
+    int status = NoError;
+    while (textIn.readLineInto(&lineStr)) {
+        if (lineStr.isEmpty()) {
+            continue;
+        }
+        QStringList strList = lineStr.split(",");
+        names << strList.at(0);
+        tooltips << strList.value(1);
+        if (strList.value(2) == QString("1")) {
+            shortListIndex << idx;
+        }
+        idx++;
+        if (names.size() == ChunkSize) {
+            if (isCancelled()) {
+                status = Cancelled;
+                break;
+            }
+            emit chunkRead(names, tooltips, shortListIndex);
+            names.clear();
+            tooltips.clear();
+            shortListIndex.clear();
+        }
+    }
+    if (status == NoError && !names.isEmpty()) {
+        emit chunkRead(names, tooltips, shortListIndex);
+    }
+    fp.close();
+    span.setItems(idx);
+    return status;
+}
+
+void CatalogCsvReader::process() {
+    emit finished(run());
+}
+
+}
@@ -0,0 +1,54 @@
+#ifndef CatalogCsvReader_H
+#define CatalogCsvReader_H
+
+#include <atomic>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+namespace Util
+{
+
+/*
+ * CatalogCsvReader reads the catalog (full list) from a CSV file with three columns per line:
+ * name, tooltip, and a flag which is "1" for the items in the short list. The catalog is
+ * delivered in chunks through chunkRead(), so the receiver can show the first items while
+ * the rest is still being read. Move it to a QThread and start process(), or call run()
+ * directly. The reading can be cancelled from any thread.
+*/
+class CatalogCsvReader : public QObject {
+    Q_OBJECT
+
+public:
+    // Status code. Same as ListFileLoader.
+    enum Status { NoError = 0, FileError = 1, Cancelled = 3 };
+    // Number of lines in a chunk
+    static const int ChunkSize = 4096;
+
+public:
+    explicit CatalogCsvReader(const QString &filename, QObject *parent = nullptr);
+    ~CatalogCsvReader() override { ; }
+    // Read the file and return the status
+    int run();
+    // Request the reading to stop. It can be called from any thread.
+    void cancel() { _cancelled.store(true); }
+    // Return true if the reading has been cancelled
+    bool isCancelled() const { return _cancelled.load(); }
+
+public slots:
+    // Run the reading and emit finished()
+    void process();
+
+signals:
+    // A chunk of the catalog. The short list index is the index of the whole catalog.
+    void chunkRead(const QStringList &names, const QStringList &tooltips, const QVector<unsigned int> &shortListIndex);
+    void finished(int status);
+
+private:
+    QString _filename;
+    std::atomic<bool> _cancelled;
+};
+
+}
+
+#endif // CatalogCsvReader_H
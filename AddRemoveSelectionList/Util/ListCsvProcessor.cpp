@@ -1,10 +1,34 @@
 #include "ListCsvProcessor.h"
+#include "ListCsvWriter.h"
+#include "Trace.h"
 #include <QFile>
 #include <QTextStream>
+#include <algorithm>
+#include <cstring>
 
 namespace Util
 {
 
+namespace
+{
+
+// Return the position of the only comma of a line read from a stream, -1 for an empty line,
+// which is skipped, or -2 if the line isn't valid. size is the size of the line without its
+// trailing '\r'. Same rule as the mapped scan.
+int commaOf(const QString &line, int &size) {
+    size = (line.endsWith('\r')) ? line.size() - 1 : line.size();
+    if (size == 0) {
+        return -1;
+    }
+    const int comma = line.indexOf(',');
+    if (comma < 0 || comma >= size || line.indexOf(',', comma + 1) >= 0) {
+        return -2;
+    }
+    return comma;
+}
+
+}
+
 ListCsvProcessor::ListCsvProcessor() {
 
 }
@@ -53,60 +77,148 @@ bool ListCsvProcessor::isValid() {
 }
 
 int ListCsvProcessor::readsListsFromFile(QStringList &slist_raw, QStringList &sList_alias) {
-    int status;
-    QFile file(_filename);
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream textIn(&file);
-        QString lineStr;
-        while (textIn.readLineInto(&lineStr)) {
-            QStringList strList = lineStr.split(",");
-            slist_raw << strList.front();
-            sList_alias << strList.back();
-        }
-        status = 0;
+    TraceSpan span("ListCsvProcessor::read");
+    const int nRaw = slist_raw.size();
+    int status = FileError;
+    if (_readMode == MappedMode) {
+        status = scanMappedFile(&slist_raw, &sList_alias);
     }
-    else {
-        status = 1;
+    if (status == FileError) {
+        status = scanStream(&slist_raw, &sList_alias);
     }
-    file.close();
+    span.setItems(slist_raw.size() - nRaw);
     return status;
 }
 
-int ListCsvProcessor::saveListsToFile(const QStringList &sList_raw, const QStringList &sList_alias) {
-    int status;
+/*
+ * The lines are checked with the same rule as the mapped scan: a trailing '\r' is dropped,
+ * empty lines are skipped and every other line must contain exactly one comma. The file is
+ * decoded as UTF-8 and a byte order mark is skipped, as in the mapped scan.
+*/
+int ListCsvProcessor::scanStream(QStringList *sList_raw, QStringList *sList_alias) {
+    // Not opened as text, so only the '\r' at the end of a line is dropped, as in the mapped scan
     QFile file(_filename);
-    if(file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&file);
-        for (int idx = 0 ; idx < sList_raw.size() ; ++idx) {
-            out << sList_raw.at(idx) << "," << sList_alias.at(idx) << "\n";
-        }
-        status = 0;
+    if (!file.open(QIODevice::ReadOnly)) {
+        return FileError;
     }
-    else {
-        status = 1;
+    const bool populate = (sList_raw && sList_alias);
+    const int nRaw = (populate) ? sList_raw->size() : 0;
+    const int nAlias = (populate) ? sList_alias->size() : 0;
+    QTextStream textIn(&file);
+    textIn.setCodec("UTF-8");
+    QString lineStr;
+    int status = NoError;
+    while (textIn.readLineInto(&lineStr)) {
+        int size = 0;
+        const int comma = commaOf(lineStr, size);
+        if (comma == -2) {
+            status = FormatError;
+            break;
+        }
+        if (comma >= 0 && populate) {
+            *sList_raw << lineStr.left(comma);
+            *sList_alias << lineStr.mid(comma + 1, size - comma - 1);
+        }
     }
     file.close();
+    // Don't leave a partially read file in the lists
+    if (status != NoError && populate) {
+        sList_raw->erase(sList_raw->begin() + nRaw, sList_raw->end());
+        sList_alias->erase(sList_alias->begin() + nAlias, sList_alias->end());
+    }
     return status;
 }
 
-bool ListCsvProcessor::performCheck() {
-    bool status = true;
+int ListCsvProcessor::saveListsToFile(const QStringList &sList_raw, const QStringList &sList_alias) {
+    TraceSpan span("ListCsvProcessor::write");
+    span.setItems(sList_raw.size());
+    ListCsvWriter writer(_filename);
+    if (!writer.open()) {
+        return FileError;
+    }
+    for (int idx = 0 ; idx < sList_raw.size() ; ++idx) {
+        writer.writeRow(sList_raw.at(idx), sList_alias.at(idx));
+    }
+    return writer.commit();
+}
+
+/*
+ * The mapped file is scanned once. Each line is located with memchr, the trailing '\r' is
+ * dropped, and the line must contain exactly one comma. Empty lines are skipped. The two
+ * fields are converted from UTF-8 straight from the mapped bytes, so no temporary line or
+ * QStringList is created per line. The lists are reserved up front by counting the lines,
+ * which is a plain byte count and much cheaper than the conversion.
+*/
+int ListCsvProcessor::scanMappedFile(QStringList *sList_raw, QStringList *sList_alias) {
     QFile file(_filename);
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream textIn(&file);
-        QString lineStr;
-        while (textIn.readLineInto(&lineStr)) {
-            if ((lineStr.count(",")+1) != 2) {
-                status = false;
+    if (!file.open(QIODevice::ReadOnly)) {
+        return FileError;
+    }
+    const qint64 size = file.size();
+    if (size == 0) {
+        return NoError;
+    }
+    const char *data = reinterpret_cast<const char *>(file.map(0, size));
+    if (!data) {
+        return FileError;
+    }
+    const char *pos = data;
+    const char *end = data + size;
+    // Skip the UTF-8 byte order mark
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        pos += 3;
+    }
+    const bool populate = (sList_raw && sList_alias);
+    const int nRaw = (populate) ? sList_raw->size() : 0;
+    const int nAlias = (populate) ? sList_alias->size() : 0;
+    if (populate) {
+        int nLine = int(std::count(pos, end, '\n')) + 1;
+        sList_raw->reserve(nRaw + nLine);
+        sList_alias->reserve(nAlias + nLine);
+    }
+    int status = NoError;
+    while (pos < end) {
+        const char *lineEnd = static_cast<const char *>(std::memchr(pos, '\n', size_t(end - pos)));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        const char *next = (lineEnd < end) ? lineEnd + 1 : end;
+        if (lineEnd > pos && *(lineEnd - 1) == '\r') {
+            lineEnd--;
+        }
+        if (lineEnd > pos) {
+            const char *comma = static_cast<const char *>(std::memchr(pos, ',', size_t(lineEnd - pos)));
+            if (!comma || std::memchr(comma + 1, ',', size_t(lineEnd - comma - 1))) {
+                status = FormatError;
                 break;
             }
+            if (populate) {
+                *sList_raw << QString::fromUtf8(pos, int(comma - pos));
+                *sList_alias << QString::fromUtf8(comma + 1, int(lineEnd - comma - 1));
+            }
         }
+        pos = next;
     }
-    else {
-        status = false;
-    }
+    file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
     file.close();
+    // Don't leave a partially read file in the lists
+    if (status != NoError && populate) {
+        sList_raw->erase(sList_raw->begin() + nRaw, sList_raw->end());
+        sList_alias->erase(sList_alias->begin() + nAlias, sList_alias->end());
+    }
     return status;
 }
 
+bool ListCsvProcessor::performCheck() {
+    TraceSpan span("ListCsvProcessor::isValid");
+    int status = FileError;
+    if (_readMode == MappedMode) {
+        status = scanMappedFile(nullptr, nullptr);
+    }
+    if (status == FileError) {
+        status = scanStream(nullptr, nullptr);
+    }
+    return (status == NoError);
+}
+
 }
@@ -12,12 +12,25 @@ namespace Util
  */
 class ListCsvProcessor {
 
+public:
+    // Status code returned by read / write
+    enum Status { NoError = 0, FileError = 1, FormatError = 2 };
+    // How a file is read. MappedMode maps the file into memory, validates and tokenizes it in
+    // one pass over the raw bytes. StreamMode reads it line by line through a QTextStream, and
+    // it's also used when the file can't be mapped. Both modes accept the same files and read
+    // the same lists: one comma per line, empty lines skipped, UTF-8.
+    enum ReadMode { MappedMode, StreamMode };
+
 public:
     ListCsvProcessor();
     ListCsvProcessor(const QString &filename);
     ~ListCsvProcessor() { ; }
     // Set the file name for read or write
     void setFile(const QString &filename) { _filename = filename; }
+    // Set the read mode
+    void setReadMode(ReadMode mode) { _readMode = mode; }
+    // Return the read mode
+    ReadMode readMode() const { return _readMode; }
     // Use the predefined file name to populate the lists.
     int getLists(QStringList &sList_raw, QStringList &sList_alias);
     // Use the predefiend file name to save the lists.
@@ -36,12 +49,19 @@ public: // Static
 private:
     // Internal member function for reading the file
     int readsListsFromFile(QStringList &slist_raw, QStringList &sList_alias);
+    // Internal member function for reading the file with QTextStream. The lists are populated
+    // when they are given, otherwise the file is only validated.
+    int scanStream(QStringList *sList_raw, QStringList *sList_alias);
+    // Internal member function for scanning a mapped file. The lists are populated when they are
+    // given, otherwise the file is only validated. Return FileError if the file can't be mapped.
+    int scanMappedFile(QStringList *sList_raw, QStringList *sList_alias);
     // Internal member function for writing lists to a file
     int saveListsToFile(const QStringList &sList_raw, const QStringList &sList_alias);
     // Performing format check
     bool performCheck();
     // Absolute filepath
     QString _filename = "";
+    ReadMode _readMode = MappedMode;
 };
 
 }
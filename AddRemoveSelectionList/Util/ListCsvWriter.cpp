@@ -0,0 +1,95 @@
+#include "ListCsvWriter.h"
+#include "Trace.h"
+
+namespace Util
+{
+
+const int ListCsvWriter::BufferSize;
+
+ListCsvWriter::ListCsvWriter(const QString &filename) :
+    _file(filename), _buffer(BufferSize, Qt::Uninitialized) {
+
+}
+
+bool ListCsvWriter::open() {
+    // Text mode, so the lines end the same way as the files written through QTextStream
+    _failed = !_file.open(QIODevice::WriteOnly | QIODevice::Text);
+    return !_failed;
+}
+
+void ListCsvWriter::writeRow(const QStringRef &raw, const QStringRef &alias) {
+    appendText(raw);
+    appendByte(',');
+    appendText(alias);
+    appendByte('\n');
+    _rowCount++;
+}
+
+int ListCsvWriter::commit() {
+    TraceSpan span("ListCsvWriter::commit");
+    span.setItems(_rowCount);
+    flush();
+    if (_failed) { // The temporary file is removed, the target is left as it was
+        return FileError;
+    }
+    return (_file.commit()) ? NoError : FileError;
+}
+
+/*
+ * A code unit takes at most 3 bytes and a surrogate pair 4, so there is room for any character
+ * once the buffer has 4 bytes left.
+*/
+void ListCsvWriter::appendText(const QStringRef &text) {
+    const ushort *data = reinterpret_cast<const ushort *>(text.unicode());
+    const int size = text.size();
+    for (int idx = 0 ; idx < size ; ++idx) {
+        if (_used > BufferSize - 4) {
+            flush();
+        }
+        char *out = _buffer.data() + _used;
+        uint code = data[idx];
+        if (code < 0x80) {
+            out[0] = char(code);
+            _used += 1;
+            continue;
+        }
+        if (code < 0x800) {
+            out[0] = char(0xC0 | (code >> 6));
+            out[1] = char(0x80 | (code & 0x3F));
+            _used += 2;
+            continue;
+        }
+        if (QChar::isSurrogate(code)) {
+            if (QChar::isHighSurrogate(code) && idx + 1 < size && QChar::isLowSurrogate(data[idx + 1])) {
+                code = QChar::surrogateToUcs4(ushort(code), data[++idx]);
+                out[0] = char(0xF0 | (code >> 18));
+                out[1] = char(0x80 | ((code >> 12) & 0x3F));
+                out[2] = char(0x80 | ((code >> 6) & 0x3F));
+                out[3] = char(0x80 | (code & 0x3F));
+                _used += 4;
+                continue;
+            }
+            code = QChar::ReplacementCharacter;
+        }
+        out[0] = char(0xE0 | (code >> 12));
+        out[1] = char(0x80 | ((code >> 6) & 0x3F));
+        out[2] = char(0x80 | (code & 0x3F));
+        _used += 3;
+    }
+}
+
+void ListCsvWriter::appendByte(char byte) {
+    if (_used == BufferSize) {
+        flush();
+    }
+    _buffer.data()[_used++] = byte;
+}
+
+void ListCsvWriter::flush() {
+    if (_used > 0 && !_failed) {
+        _failed = (_file.write(_buffer.constData(), _used) != _used);
+    }
+    _used = 0;
+}
+
+}
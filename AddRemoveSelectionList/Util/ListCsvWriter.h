@@ -0,0 +1,57 @@
+#ifndef ListCsvWriter_H
+#define ListCsvWriter_H
+
+#include <QByteArray>
+#include <QSaveFile>
+#include <QString>
+#include <QStringRef>
+
+namespace Util
+{
+
+/*
+ * ListCsvWriter streams the rows of a selected list CSV file. Each row is encoded to UTF-8
+ * straight into a fixed write buffer, which is written out whenever it's full, so saving never
+ * builds the lists or the file content in memory. The rows go to a temporary file next to the
+ * target, and commit() renames it over the target at once: the target is either the old file
+ * or the complete new one, never a truncated one. Nothing is replaced if commit() isn't called.
+*/
+class ListCsvWriter {
+
+public:
+    // Status code. Same as ListCsvProcessor.
+    enum Status { NoError = 0, FileError = 1 };
+    // Size of the write buffer in bytes
+    static const int BufferSize = 1 << 20;
+
+public:
+    explicit ListCsvWriter(const QString &filename);
+    ~ListCsvWriter() { ; }
+    // Open the temporary file. Return false if it can't be created.
+    bool open();
+    // Append a row
+    void writeRow(const QStringRef &raw, const QStringRef &alias);
+    void writeRow(const QString &raw, const QString &alias) { writeRow(QStringRef(&raw), QStringRef(&alias)); }
+    // Write the rest of the buffer and replace the target. Return the status.
+    int commit();
+    // Return the number of rows written so far
+    qint64 rowCount() const { return _rowCount; }
+
+private:
+    // Encode UTF-16 text to UTF-8 into the buffer. A lone surrogate is written as U+FFFD.
+    void appendText(const QStringRef &text);
+    void appendByte(char byte);
+    // Write the buffer to the file
+    void flush();
+
+private:
+    QSaveFile _file;
+    QByteArray _buffer;
+    int _used = 0;
+    qint64 _rowCount = 0;
+    bool _failed = false;
+};
+
+}
+
+#endif // ListCsvWriter_H
@@ -0,0 +1,145 @@
+#include "ListFileLoader.h"
+#include "ListCsvProcessor.h"
+#include "ListSnapshotProcessor.h"
+#include "Trace.h"
+#include <QHash>
+
+namespace Util
+{
+
+namespace
+{
+
+// Number of items processed between two checks of the cancel request
+const int CheckInterval = 4096;
+
+}
+
+ListFileLoader::ListFileLoader(const QString &filename, const Catalog &catalog, quint64 fingerprint, QObject *parent) :
+    QObject(parent), _filename(filename), _catalog(catalog), _fingerprint(fingerprint), _cancelled(false) {
+
+}
+
+int ListFileLoader::run() {
+    TraceSpan span("ListFileLoader::run");
+    _index.clear();
+    _aliasList.clear();
+    reportProgress(0);
+    int status = (ListSnapshotProcessor::isSnapshot(_filename)) ? readSnapshot() : readCsv();
+    if (status == NoError && isCancelled()) {
+        status = Cancelled;
+    }
+    if (status != NoError) {
+        _index.clear();
+        _aliasList.clear();
+    }
+    else {
+        reportProgress(100);
+    }
+    span.setItems(qint64(_index.size()));
+    return status;
+}
+
+void ListFileLoader::process() {
+    emit finished(run());
+}
+
+int ListFileLoader::readSnapshot() {
+    ListSnapshot snapshot;
+    int status = ListSnapshotProcessor::read(_filename, snapshot);
+    if (status != NoError) {
+        return status;
+    }
+    reportProgress(30);
+    return resolveSnapshot(snapshot);
+}
+
+int ListFileLoader::resolveSnapshot(ListSnapshot &snapshot) {
+    // The index can be used as it is only if the snapshot was taken from the same full list
+    bool sameFullList = (snapshot.fingerprint == _fingerprint && snapshot.fullListSize == unsigned(_catalog.size()));
+    for (unsigned int idx = 0 ; sameFullList && idx < snapshot.index.size() ; ++idx) {
+        sameFullList = (snapshot.index.at(idx) < unsigned(_catalog.size()));
+    }
+    // Aliases which weren't stored are the default names
+    QStringList sList_alias;
+    sList_alias.reserve(int(snapshot.index.size()));
+    auto alias = snapshot.aliasList.begin();
+    for (unsigned int pos = 0 ; pos < snapshot.index.size() ; ++pos) {
+        if (alias != snapshot.aliasList.end() && alias->first == pos) {
+            sList_alias << alias->second;
+            ++alias;
+        }
+        else if (sameFullList) {
+            sList_alias << _catalog.name(int(snapshot.index.at(pos)));
+        }
+        else {
+            sList_alias << snapshot.rawList.value(int(pos));
+        }
+    }
+    if (sameFullList) {
+        _index.swap(snapshot.index);
+        _aliasList = sList_alias;
+        return NoError;
+    }
+    // Fall back to matching the names
+    return (resolveNames(snapshot.rawList, sList_alias)) ? NoError : Cancelled;
+}
+
+int ListFileLoader::readCsv() {
+    QStringList sList_raw, sList_alias;
+    int status = ListCsvProcessor::read(_filename, sList_raw, sList_alias);
+    if (status != NoError) {
+        return status;
+    }
+    reportProgress(30);
+    return (resolveNames(sList_raw, sList_alias)) ? NoError : Cancelled;
+}
+
+bool ListFileLoader::resolveNames(const QStringList &sList_raw, const QStringList &sList_alias) {
+    TraceSpan span("ListFileLoader::resolveNames");
+    span.setItems(sList_raw.size());
+    _index.clear();
+    _aliasList.clear();
+    // Hash the full list once instead of searching it for every name. The first entry wins
+    // when a name appears more than once, same as QStringList::indexOf(). The keys point into
+    // the catalog, so no name is copied.
+    QHash<QStringRef, int> fullListHash;
+    fullListHash.reserve(_catalog.size());
+    for (int idx = 0 ; idx < _catalog.size() ; ++idx) {
+        if ((idx % CheckInterval) == 0) {
+            if (isCancelled()) {
+                return false;
+            }
+            reportProgress(30 + int(30LL * idx / _catalog.size()));
+        }
+        const QStringRef name = _catalog.nameRef(idx);
+        if (!fullListHash.contains(name)) {
+            fullListHash.insert(name, idx);
+        }
+    }
+    _index.reserve(unsigned(sList_raw.size()));
+    _aliasList.reserve(sList_raw.size());
+    for (int idx = 0 ; idx < sList_raw.size() ; ++idx) {
+        if ((idx % CheckInterval) == 0) {
+            if (isCancelled()) {
+                return false;
+            }
+            reportProgress(60 + int(40LL * idx / sList_raw.size()));
+        }
+        auto found = fullListHash.constFind(QStringRef(&sList_raw.at(idx)));
+        if (found != fullListHash.constEnd()) {
+            _index.push_back(unsigned(found.value()));
+            _aliasList << sList_alias.value(idx, sList_raw.at(idx));
+        }
+    }
+    return true;
+}
+
+void ListFileLoader::reportProgress(int percent) {
+    if (percent != _progress) {
+        _progress = percent;
+        emit progress(percent);
+    }
+}
+
+}
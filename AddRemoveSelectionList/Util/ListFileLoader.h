@@ -0,0 +1,78 @@
+#ifndef ListFileLoader_H
+#define ListFileLoader_H
+
+#include <atomic>
+#include <vector>
+#include <QObject>
+#include <QStringList>
+#include "Catalog.h"
+#include "ListSnapshotProcessor.h"
+
+namespace Util
+{
+
+/*
+ * ListFileLoader reads a selected list file, either a CSV file or a binary snapshot, and
+ * resolves the items to their index of the full list. It doesn't touch any widget, so it can
+ * run on a worker thread: move it to a QThread and start process(), or call run() directly.
+ * The catalog is kept as an implicitly shared copy, so it is safe to read it here while the
+ * GUI thread keeps using its own. The loading can be cancelled from any thread.
+*/
+class ListFileLoader : public QObject {
+    Q_OBJECT
+
+public:
+    // Status code. The first three are the same as ListCsvProcessor.
+    enum Status { NoError = 0, FileError = 1, FormatError = 2, Cancelled = 3 };
+
+public:
+    ListFileLoader(const QString &filename, const Catalog &catalog, quint64 fingerprint, QObject *parent = nullptr);
+    ~ListFileLoader() override { ; }
+    // Load the file and return the status
+    int run();
+    // Request the loading to stop. It can be called from any thread.
+    void cancel() { _cancelled.store(true); }
+    // Return true if the loading has been cancelled
+    bool isCancelled() const { return _cancelled.load(); }
+    // Return the fingerprint of the full list which the result refers to
+    quint64 fingerprint() const { return _fingerprint; }
+    // Return the index of the full list of the loaded items
+    const std::vector<unsigned int> &index() const { return _index; }
+    // Return the aliases of the loaded items
+    const QStringList &aliasList() const { return _aliasList; }
+    // Resolve the raw names to their index of the full list. The names which are not in the full
+    // list are dropped together with their aliases. Return false if it's cancelled.
+    bool resolveNames(const QStringList &sList_raw, const QStringList &sList_alias);
+    // Resolve the items of a snapshot, by their index if it was taken from the same full list,
+    // otherwise by their names. The index may be taken out of the snapshot. Return the status.
+    int resolveSnapshot(ListSnapshot &snapshot);
+
+public slots:
+    // Run the loading and emit finished()
+    void process();
+
+signals:
+    void progress(int percent);
+    void finished(int status);
+
+private:
+    // Read a binary snapshot
+    int readSnapshot();
+    // Read a CSV file
+    int readCsv();
+    // Emit the progress only when it changes
+    void reportProgress(int percent);
+
+private:
+    QString _filename;
+    Catalog _catalog;
+    quint64 _fingerprint = 0;
+    std::atomic<bool> _cancelled;
+    int _progress = -1;
+    std::vector<unsigned int> _index;
+    QStringList _aliasList;
+};
+
+}
+
+#endif // ListFileLoader_H
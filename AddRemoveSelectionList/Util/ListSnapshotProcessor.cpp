@@ -0,0 +1,220 @@
+#include "ListSnapshotProcessor.h"
+#include "Trace.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+#include <QSysInfo>
+#include <algorithm>
+#include <cstring>
+
+namespace Util
+{
+
+namespace
+{
+
+const char SnapshotSignature[4] = {'A', 'R', 'S', 'S'};
+const quint16 SnapshotVersion = 1;
+const int HeaderSize = 4 + 2 + 2 + 8 + 4 + 4 + 4;
+
+void appendU16(QByteArray &buffer, quint16 value) {
+    uchar bytes[2];
+    qToLittleEndian(value, bytes);
+    buffer.append(reinterpret_cast<const char *>(bytes), 2);
+}
+
+void appendU32(QByteArray &buffer, quint32 value) {
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    buffer.append(reinterpret_cast<const char *>(bytes), 4);
+}
+
+void appendU64(QByteArray &buffer, quint64 value) {
+    uchar bytes[8];
+    qToLittleEndian(value, bytes);
+    buffer.append(reinterpret_cast<const char *>(bytes), 8);
+}
+
+const quint64 FingerprintPrime = 1099511628211ULL;
+const quint64 FingerprintBasis = 14695981039346656037ULL;
+
+// Add a name to a fingerprint
+inline quint64 fingerprintName(quint64 hash, const ushort *data, int size) {
+    for (int idx = 0 ; idx < size ; ++idx) {
+        hash = (hash ^ data[idx]) * FingerprintPrime;
+    }
+    return (hash ^ 0xFFFF) * FingerprintPrime;
+}
+
+void appendString(QByteArray &buffer, const QString &str) {
+    QByteArray utf8 = str.toUtf8();
+    appendU32(buffer, quint32(utf8.size()));
+    buffer.append(utf8);
+}
+
+/*
+ * A cursor over the mapped file. Every read is bounds checked, a read past the end puts the
+ * cursor in the failed state and returns zero / empty values from then on.
+*/
+class SnapshotReader {
+public:
+    SnapshotReader(const uchar *data, qint64 size) : _pos(data), _end(data + size) { ; }
+    bool failed() const { return _failed; }
+    const uchar *take(qint64 size) {
+        if (_failed || size < 0 || (_end - _pos) < size) {
+            _failed = true;
+            return nullptr;
+        }
+        const uchar *data = _pos;
+        _pos += size;
+        return data;
+    }
+    quint16 u16() { const uchar *data = take(2); return (data) ? qFromLittleEndian<quint16>(data) : 0; }
+    quint32 u32() { const uchar *data = take(4); return (data) ? qFromLittleEndian<quint32>(data) : 0; }
+    quint64 u64() { const uchar *data = take(8); return (data) ? qFromLittleEndian<quint64>(data) : 0; }
+    QString string() {
+        quint32 size = u32();
+        const uchar *data = take(qint64(size));
+        return (data) ? QString::fromUtf8(reinterpret_cast<const char *>(data), int(size)) : QString();
+    }
+private:
+    const uchar *_pos;
+    const uchar *_end;
+    bool _failed = false;
+};
+
+}
+
+int ListSnapshotProcessor::read(const QString &filename, ListSnapshot &snapshot) {
+    TraceSpan span("ListSnapshotProcessor::read");
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return FileError;
+    }
+    const qint64 size = file.size();
+    const uchar *data = (size >= HeaderSize) ? file.map(0, size) : nullptr;
+    if (!data) {
+        return (size >= HeaderSize) ? FileError : FormatError;
+    }
+    int status = fromData(data, size, snapshot);
+    file.unmap(const_cast<uchar *>(data));
+    file.close();
+    span.setItems(qint64(snapshot.index.size()));
+    return status;
+}
+
+int ListSnapshotProcessor::fromData(const uchar *data, qint64 size, ListSnapshot &snapshot) {
+    if (size < HeaderSize) {
+        return FormatError;
+    }
+    SnapshotReader reader(data, size);
+    const uchar *signature = reader.take(4);
+    quint16 version = reader.u16();
+    reader.u16(); // Reserved
+    if (std::memcmp(signature, SnapshotSignature, 4) != 0 || version != SnapshotVersion) {
+        return FormatError;
+    }
+    snapshot.fingerprint = reader.u64();
+    snapshot.fullListSize = reader.u32();
+    quint32 nItem = reader.u32();
+    quint32 nAlias = reader.u32();
+    // The index is copied as a block
+    const uchar *index = reader.take(qint64(nItem) * 4);
+    if (index) {
+        snapshot.index.resize(nItem);
+        // An empty index has no storage to copy to
+        if (nItem > 0 && QSysInfo::ByteOrder == QSysInfo::LittleEndian && sizeof(unsigned int) == 4) {
+            std::memcpy(snapshot.index.data(), index, size_t(nItem) * 4);
+        }
+        else {
+            for (quint32 idx = 0 ; idx < nItem ; ++idx) {
+                snapshot.index[idx] = qFromLittleEndian<quint32>(index + idx * 4);
+            }
+        }
+    }
+    snapshot.aliasList.clear();
+    snapshot.aliasList.reserve(std::min<quint32>(nAlias, nItem));
+    for (quint32 idx = 0 ; idx < nAlias && !reader.failed() ; ++idx) {
+        quint32 position = reader.u32();
+        QString alias = reader.string();
+        if (position < nItem) {
+            snapshot.aliasList.push_back(std::make_pair(unsigned(position), alias));
+        }
+    }
+    snapshot.rawList.clear();
+    snapshot.rawList.reserve(int(nItem));
+    for (quint32 idx = 0 ; idx < nItem && !reader.failed() ; ++idx) {
+        snapshot.rawList << reader.string();
+    }
+    return (reader.failed()) ? FormatError : NoError;
+}
+
+int ListSnapshotProcessor::write(const QString &filename, const ListSnapshot &snapshot) {
+    TraceSpan span("ListSnapshotProcessor::write");
+    span.setItems(qint64(snapshot.index.size()));
+    QByteArray buffer = toData(snapshot);
+    // Written to a temporary file which replaces the target only once it's complete
+    QSaveFile file(filename);
+    if (file.open(QIODevice::WriteOnly) && file.write(buffer) == buffer.size() && file.commit()) {
+        return NoError;
+    }
+    return FileError;
+}
+
+QByteArray ListSnapshotProcessor::toData(const ListSnapshot &snapshot) {
+    // Prepare the whole file in memory so it's written with a single call
+    QByteArray buffer;
+    buffer.reserve(HeaderSize + int(snapshot.index.size()) * 4);
+    buffer.append(SnapshotSignature, 4);
+    appendU16(buffer, SnapshotVersion);
+    appendU16(buffer, 0);
+    appendU64(buffer, snapshot.fingerprint);
+    appendU32(buffer, snapshot.fullListSize);
+    appendU32(buffer, quint32(snapshot.index.size()));
+    appendU32(buffer, quint32(snapshot.aliasList.size()));
+    for (const unsigned int &idx : snapshot.index) {
+        appendU32(buffer, idx);
+    }
+    for (const auto &alias : snapshot.aliasList) {
+        appendU32(buffer, alias.first);
+        appendString(buffer, alias.second);
+    }
+    for (int idx = 0 ; idx < int(snapshot.index.size()) ; ++idx) {
+        appendString(buffer, (idx < snapshot.rawList.size()) ? snapshot.rawList.at(idx) : QString());
+    }
+    return buffer;
+}
+
+bool ListSnapshotProcessor::isSnapshot(const QString &filename) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray signature = file.read(4);
+    file.close();
+    return signature == QByteArray(SnapshotSignature, 4);
+}
+
+/*
+ * 64-bit FNV-1a over the UTF-16 code units of every name. Each name is followed by a 0xFFFF
+ * code unit, which never appears in a valid string, so moving a character from one name to
+ * the next changes the fingerprint.
+*/
+quint64 ListSnapshotProcessor::fingerprint(const QStringList &fullList) {
+    quint64 hash = FingerprintBasis;
+    for (const QString &name : fullList) {
+        hash = fingerprintName(hash, name.utf16(), name.size());
+    }
+    return (hash ^ quint64(fullList.size())) * FingerprintPrime;
+}
+
+quint64 ListSnapshotProcessor::fingerprint(const Catalog &catalog) {
+    quint64 hash = FingerprintBasis;
+    for (int idx = 0 ; idx < catalog.size() ; ++idx) {
+        const QStringRef name = catalog.nameRef(idx);
+        hash = fingerprintName(hash, reinterpret_cast<const ushort *>(name.unicode()), name.size());
+    }
+    return (hash ^ quint64(catalog.size())) * FingerprintPrime;
+}
+
+}
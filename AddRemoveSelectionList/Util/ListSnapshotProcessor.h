@@ -0,0 +1,67 @@
+#ifndef ListSnapshotProcessor_H
+#define ListSnapshotProcessor_H
+
+#include <vector>
+#include <utility>
+#include <QStringList>
+#include "Catalog.h"
+
+namespace Util
+{
+
+/*
+ * ListSnapshot is the content of a binary selection snapshot. The selected items are stored
+ * as their index of the full list, together with the fingerprint of the full list they refer
+ * to. Only the aliases which differ from the default name of the item are kept. The raw names
+ * are kept as well so the selection can still be matched by name against a different list.
+*/
+struct ListSnapshot {
+    // Fingerprint of the full list (see ListSnapshotProcessor::fingerprint())
+    quint64 fingerprint = 0;
+    // Size of the full list
+    unsigned int fullListSize = 0;
+    // Index of the selected items in the full list
+    std::vector<unsigned int> index;
+    // Raw names of the selected items
+    QStringList rawList;
+    // Aliases differ from the default name as (position in index, alias), sorted by position
+    std::vector<std::pair<unsigned int, QString>> aliasList;
+};
+
+/*
+ * ListSnapshotProcessor read / write a selection snapshot from / to a binary file. Comparing
+ * to the CSV file, the snapshot can be loaded without looking up any name when the full list
+ * hasn't changed. All numbers are little endian.
+ *
+ *   Header  : "ARSS", quint16 version, quint16 reserved, quint64 fingerprint,
+ *             quint32 full list size, quint32 item count, quint32 alias count
+ *   Index   : quint32 x item count
+ *   Aliases : (quint32 position, quint32 byte size, UTF-8 bytes) x alias count
+ *   Names   : (quint32 byte size, UTF-8 bytes) x item count
+*/
+class ListSnapshotProcessor {
+
+public:
+    // Status code returned by read / write. Same as ListCsvProcessor.
+    enum Status { NoError = 0, FileError = 1, FormatError = 2 };
+
+public: // Static
+    // Read a snapshot from a file. status = 0 means no error, otherwise, return a error code number.
+    int static read(const QString &filename, ListSnapshot &snapshot);
+    // Write a snapshot to a file. status = 0 means no error, otherwise, return a error code number.
+    int static write(const QString &filename, const ListSnapshot &snapshot);
+    // Same as read / write on the content of a file in memory, e.g. a snapshot embedded in
+    // another file
+    int static fromData(const uchar *data, qint64 size, ListSnapshot &snapshot);
+    QByteArray static toData(const ListSnapshot &snapshot);
+    // Return true if the file starts with the snapshot signature
+    bool static isSnapshot(const QString &filename);
+    // Return the fingerprint of a full list. Any change of the names or the order changes it.
+    quint64 static fingerprint(const QStringList &fullList);
+    // Same as above for a catalog, without copying the names
+    quint64 static fingerprint(const Catalog &catalog);
+};
+
+}
+
+#endif // ListSnapshotProcessor_H
@@ -0,0 +1,152 @@
+#include "NameSanitizer.h"
+#include <cstring>
+// The vectorized check is built for any x86 target with GCC or Clang and used only when the
+// CPU has SSSE3, unless the whole build already requires it
+#if defined(__SSSE3__)
+#define NAMESANITIZER_SSSE3 1
+#define NAMESANITIZER_SSSE3_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define NAMESANITIZER_SSSE3 1
+#define NAMESANITIZER_SSSE3_DISPATCH 1
+#define NAMESANITIZER_SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+#if defined(NAMESANITIZER_SSSE3)
+#include <tmmintrin.h>
+#endif
+
+namespace Util
+{
+
+namespace
+{
+
+// [a-zA-Z0-9_] in the layout of NamingPolicy::table()
+const uchar IdentifierTable[16] = {
+    0xA8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8,
+    0xF8, 0xF8, 0xF0, 0x50, 0x50, 0x50, 0x50, 0x70
+};
+
+#if defined(NAMESANITIZER_SSSE3)
+/*
+ * Return the number of leading code units checked to be allowed, 16 at a time. The units are
+ * packed to bytes with unsigned saturation, so a unit above 0xFF becomes 0xFF and a unit above
+ * 0x7FFF becomes 0, neither of which can be allowed. The low nibble of each byte picks its row
+ * of the table, and the high nibble picks the bit in the row (zero for non-ASCII bytes).
+*/
+NAMESANITIZER_SSSE3_TARGET int allowedPrefix(const ushort *data, int size, const uchar *table) {
+    // The table is in a NamingPolicy, which may be on a heap block with less than 16 byte alignment
+    const __m128i rows = _mm_loadu_si128(reinterpret_cast<const __m128i *>(table));
+    const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, char(0x80), 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    int pos = 0;
+    for ( ; pos + 16 <= size ; pos += 16) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos + 8));
+        __m128i bytes = _mm_packus_epi16(low, high);
+        __m128i row = _mm_shuffle_epi8(rows, _mm_and_si128(bytes, nibble));
+        __m128i bit = _mm_shuffle_epi8(bits, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), zero)) != 0) {
+            break;
+        }
+    }
+    return pos;
+}
+
+// Return true if allowedPrefix() can run on this CPU
+bool hasSsse3() {
+#if defined(NAMESANITIZER_SSSE3_DISPATCH)
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+#else
+    return true;
+#endif
+}
+#endif
+
+}
+
+NamingPolicy::NamingPolicy() : _replacement('_') {
+    std::memcpy(_table, IdentifierTable, sizeof(_table));
+}
+
+void NamingPolicy::setAllowed(const QString &chars, bool allowed) {
+    for (const QChar &ch : chars) {
+        setAllowed(ch.unicode(), allowed);
+    }
+}
+
+void NamingPolicy::setAllowedRange(char first, char last, bool allowed) {
+    for (int ch = first ; ch <= last ; ++ch) {
+        setAllowed(ushort(ch), allowed);
+    }
+}
+
+void NamingPolicy::setAllowed(ushort unit, bool allowed) {
+    // '\0' is never allowed, the vectorized check maps the units above 0x7FFF to it
+    if (unit == 0 || unit >= 128) {
+        return;
+    }
+    if (allowed) {
+        _table[unit & 15] |= uchar(1 << (unit >> 4));
+    }
+    else {
+        _table[unit & 15] &= uchar(~(1 << (unit >> 4)));
+    }
+}
+
+int NameSanitizer::firstInvalid(const ushort *data, int size, const NamingPolicy &policy) {
+    int pos = 0;
+#if defined(NAMESANITIZER_SSSE3)
+    if (hasSsse3()) {
+        pos = allowedPrefix(data, size, policy.table());
+    }
+#endif
+    while (pos < size && policy.isAllowed(data[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+bool NameSanitizer::sanitize(QString &name, const NamingPolicy &policy) {
+    const int size = name.size();
+    int in = firstInvalid(name.utf16(), size, policy);
+    if (in == size) {
+        return false;
+    }
+    // The output never gets ahead of the input, so the name is rewritten in place
+    ushort *data = reinterpret_cast<ushort *>(name.data());
+    const ushort replacement = policy.replacement().unicode();
+    int out = in;
+    for ( ; in < size ; ++in) {
+        if (policy.isAllowed(data[in])) {
+            data[out++] = data[in];
+            continue;
+        }
+        if (QChar::isHighSurrogate(data[in]) && in + 1 < size && QChar::isLowSurrogate(data[in + 1])) {
+            in++;
+        }
+        data[out++] = replacement;
+    }
+    name.truncate(out);
+    return true;
+}
+
+std::vector<int> NameSanitizer::sanitize(QStringList &names, const NamingPolicy &policy) {
+    std::vector<int> changed;
+    for (int idx = 0 ; idx < names.size() ; ++idx) {
+        // Only the names which need a change are detached
+        const QString &name = names.at(idx);
+        if (firstInvalid(name.utf16(), name.size(), policy) != name.size()) {
+            sanitize(names[idx], policy);
+            changed.push_back(idx);
+        }
+    }
+    return changed;
+}
+
+bool NameSanitizer::isValid(const QString &name, const NamingPolicy &policy) {
+    return firstInvalid(name.utf16(), name.size(), policy) == name.size();
+}
+
+}
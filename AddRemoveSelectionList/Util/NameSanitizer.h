@@ -0,0 +1,66 @@
+#ifndef NameSanitizer_H
+#define NameSanitizer_H
+
+#include <vector>
+#include <QString>
+#include <QStringList>
+
+namespace Util
+{
+
+/*
+ * NamingPolicy is the set of characters allowed in an alias, and the character which replaces
+ * the others. Only ASCII characters can be allowed. The set is a 16-byte table: bit (c >> 4)
+ * of table[c & 15] is set if the character c is allowed, which is the layout the vectorized
+ * check in NameSanitizer looks up directly.
+*/
+class NamingPolicy {
+
+public:
+    // The default policy allows [a-zA-Z0-9_] and replaces everything else with '_'
+    NamingPolicy();
+    // Allow / disallow each character of chars. Non-ASCII characters and '\0' are ignored.
+    void setAllowed(const QString &chars, bool allowed = true);
+    // Allow / disallow the ASCII characters from first to last
+    void setAllowedRange(char first, char last, bool allowed = true);
+    // Set the character which replaces the characters not allowed
+    void setReplacement(QChar replacement) { _replacement = replacement; }
+    // Return the character which replaces the characters not allowed
+    QChar replacement() const { return _replacement; }
+    // Return true if the UTF-16 code unit is allowed
+    bool isAllowed(ushort unit) const { return unit < 128 && ((_table[unit & 15] >> (unit >> 4)) & 1); }
+    // Return the character class table
+    const uchar *table() const { return _table; }
+
+private:
+    void setAllowed(ushort unit, bool allowed);
+
+private:
+    alignas(16) uchar _table[16];
+    QChar _replacement;
+};
+
+/*
+ * NameSanitizer replaces the characters which are not allowed by a naming policy. A name is
+ * first checked for the allowed characters, 16 code units at a time when SSSE3 is available,
+ * and only a name which needs a change is detached and rewritten in place. A character which
+ * is not allowed is replaced by a single replacement character, including a surrogate pair.
+*/
+class NameSanitizer {
+
+public: // Static
+    // Sanitize a name in place. Return true if it has changed.
+    bool static sanitize(QString &name, const NamingPolicy &policy);
+    // Sanitize all the names in place. Return the positions of the names which have changed.
+    std::vector<int> static sanitize(QStringList &names, const NamingPolicy &policy);
+    // Return true if the name only has allowed characters
+    bool static isValid(const QString &name, const NamingPolicy &policy);
+
+private:
+    // Return the position of the first code unit which isn't allowed, or size if there's none
+    int static firstInvalid(const ushort *data, int size, const NamingPolicy &policy);
+};
+
+}
+
+#endif // NameSanitizer_H
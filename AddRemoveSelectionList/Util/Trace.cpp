@@ -0,0 +1,168 @@
+#include "Trace.h"
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+
+namespace Util
+{
+
+namespace
+{
+
+struct TraceEvent {
+    const char *name;
+    char phase;   // 'X' for a span, 'i' for an instant
+    qint64 begin; // ns
+    qint64 end;   // ns
+    quintptr thread;
+    qint64 items;
+};
+
+/*
+ * The timer is started once and never restarted, so now() reads it without the lock: a
+ * tracing session only moves the origin. The state is never destroyed, because the session is
+ * stopped from the destructor of a static object which can run after the state's one.
+*/
+struct TraceState {
+    TraceState() : origin(0) { timer.start(); }
+    QMutex mutex;
+    QString filename;
+    QElapsedTimer timer;
+    std::atomic<qint64> origin; // ns on the timer when the tracing started
+    std::vector<TraceEvent> events;
+};
+
+TraceState &traceState() {
+    static TraceState *state = new TraceState;
+    return *state;
+}
+
+void record(const TraceEvent &event) {
+    TraceState &state = traceState();
+    QMutexLocker locker(&state.mutex);
+    if (Trace::isEnabled()) { // Not stopped by another thread in between
+        state.events.push_back(event);
+    }
+}
+
+// Microseconds with the nanoseconds as decimals, which is the unit of the trace event format
+QString micro(qint64 ns) {
+    return QString::number(double(ns) / 1000.0, 'f', 3);
+}
+
+/*
+ * Turns the tracing on for the whole run when ADDREMOVESELECTION_TRACE is set, and writes the
+ * file when the program exits.
+*/
+struct TraceSession {
+    TraceSession() {
+        QString filename = QString::fromLocal8Bit(qgetenv("ADDREMOVESELECTION_TRACE"));
+        if (!filename.isEmpty()) {
+            Trace::start(filename);
+        }
+    }
+    ~TraceSession() {
+        Trace::stop();
+    }
+};
+
+TraceSession traceSession;
+
+}
+
+std::atomic<bool> Trace::_enabled(false);
+
+bool Trace::start(const QString &filename) {
+    TraceState &state = traceState();
+    QMutexLocker locker(&state.mutex);
+    if (filename.isEmpty() || isEnabled()) {
+        return false;
+    }
+    state.filename = filename;
+    state.events.clear();
+    state.origin.store(state.timer.nsecsElapsed());
+    _enabled.store(true);
+    return true;
+}
+
+/*
+ * The threads are numbered in the order they first appear, which keeps the track names short
+ * in the viewer. The spans are written as complete events ("ph":"X") with their item count in
+ * the arguments.
+*/
+bool Trace::stop() {
+    if (!isEnabled()) {
+        return true;
+    }
+    TraceState &state = traceState();
+    std::vector<TraceEvent> events;
+    QString filename;
+    {
+        QMutexLocker locker(&state.mutex);
+        if (!isEnabled()) {
+            return true;
+        }
+        _enabled.store(false);
+        events.swap(state.events);
+        filename = state.filename;
+    }
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    const qint64 pid = QCoreApplication::applicationPid();
+    std::unordered_map<quintptr, int> threadId;
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":\"AddRemoveSelection\"}}";
+    for (const TraceEvent &event : events) {
+        auto thread = threadId.insert(std::make_pair(event.thread, int(threadId.size()) + 1));
+        const int tid = thread.first->second;
+        if (thread.second) {
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid
+                << ",\"args\":{\"name\":\"Thread " << tid << "\"}}";
+        }
+        out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"pid\":" << pid
+            << ",\"tid\":" << tid << ",\"ts\":" << micro(event.begin);
+        if (event.phase == 'X') {
+            out << ",\"dur\":" << micro(event.end - event.begin);
+        }
+        else {
+            out << ",\"s\":\"t\"";
+        }
+        if (event.items >= 0) {
+            out << ",\"args\":{\"items\":" << event.items << "}";
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+    out.flush();
+    bool status = (file.error() == QFile::NoError);
+    file.close();
+    return status;
+}
+
+void Trace::instant(const char *name) {
+    if (isEnabled()) {
+        const qint64 time = now();
+        record(TraceEvent{name, 'i', time, time, quintptr(QThread::currentThreadId()), -1});
+    }
+}
+
+void Trace::complete(const char *name, qint64 begin, qint64 end, qint64 items) {
+    record(TraceEvent{name, 'X', begin, end, quintptr(QThread::currentThreadId()), items});
+}
+
+qint64 Trace::now() {
+    const TraceState &state = traceState();
+    return state.timer.nsecsElapsed() - state.origin.load();
+}
+
+}
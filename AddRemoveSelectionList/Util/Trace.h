@@ -0,0 +1,71 @@
+#ifndef Trace_H
+#define Trace_H
+
+#include <atomic>
+#include <QString>
+
+namespace Util
+{
+
+/*
+ * Trace records spans of time in the Chrome trace event format, which can be opened in
+ * Perfetto (ui.perfetto.dev) or chrome://tracing. Tracing is off by default. It's turned on
+ * for the whole run by setting the environment variable ADDREMOVESELECTION_TRACE to the output
+ * file, or around a part of the run with start() / stop(). The events are kept in memory and
+ * written to the file when the tracing stops, or when the program exits.
+ *
+ * The names must be string literals: only the pointer is kept.
+*/
+class Trace {
+
+public:
+    // Start recording. The events are written to the file when the tracing stops.
+    bool static start(const QString &filename);
+    // Stop recording and write the events. Return false if the file can't be written.
+    bool static stop();
+    // Return true while recording
+    bool static isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+    // Record a point in time, e.g. an event of a view
+    void static instant(const char *name);
+    // Record a span from begin to end (from now()). items < 0 means no item count.
+    void static complete(const char *name, qint64 begin, qint64 end, qint64 items);
+    // Return the time since the tracing started in nanoseconds
+    qint64 static now();
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+/*
+ * TraceSpan records the time from its construction to its destruction, with the number of
+ * items it has processed. When the tracing is off, it's only a flag check.
+ *
+ *     Util::TraceSpan span("populateAvailableList");
+ *     ...
+ *     span.setItems(index.size());
+*/
+class TraceSpan {
+
+public:
+    explicit TraceSpan(const char *name) : _name(name), _begin(Trace::isEnabled() ? Trace::now() : -1) { ; }
+    ~TraceSpan() {
+        if (_begin >= 0) {
+            Trace::complete(_name, _begin, Trace::now(), _items);
+        }
+    }
+    // Set the number of items processed in the span
+    void setItems(qint64 items) { _items = items; }
+
+private:
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *_name;
+    qint64 _begin;
+    qint64 _items = -1;
+};
+
+}
+
+#endif // Trace_H
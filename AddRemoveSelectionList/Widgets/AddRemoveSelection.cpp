@@ -10,21 +10,26 @@
 #include "AddRemoveSelection.h"
 #include "ui_AddRemoveSelection.h"
 #include <algorithm>
-#include <functional>
-#include <QFile>
-#include <QTextStream>
 #include <QFileDialog>
 #include <QSizePolicy>
-#include <QRegularExpression>
 #include <QPoint>
-#include <Util/ListCsvProcessor.h>
+#include <QDropEvent>
+#include <QThread>
+#include <QProgressDialog>
+#include <QAction>
+#include "SelectionCommands.h"
+#include <Util/ListFileLoader.h>
+#include <Util/Trace.h>
 
 namespace Widgets
 {
 
 AddRemoveSelection::AddRemoveSelection(QWidget *parent) :
     QWidget(parent),
-    ui(new Ui::AddRemoveSelection)
+    ui(new Ui::AddRemoveSelection),
+    _selectedItemModel(&_engine),
+    _journal(&_engine),
+    _publisher(&_engine)
 {   // Enable drag/drop
     ui->setupUi(this);
     // Retain _messageLabel size
@@ -34,7 +39,11 @@ AddRemoveSelection::AddRemoveSelection(QWidget *parent) :
     // Checkbox
     ui->_fullListCheckBox->setHidden(true);
     ui->_fullListCheckBox->setChecked(true);
+    ui->_viewComboBox->setHidden(true);
+    // Follow the changes of the selection
+    _engine.addObserver(this);
     // Available list view
+    _availableItemModel.setCatalog(&_engine.catalog());
     ui->_availableListView->setModel(&_availableItemModel);
     ui->_availableListView->setEditTriggers(QAbstractItemView::NoEditTriggers); // Disable edit once for all. Otherwise, set the item flag for each item.
     ui->_availableListView->setSelectionMode(QAbstractItemView::ExtendedSelection);
@@ -54,190 +63,248 @@ AddRemoveSelection::AddRemoveSelection(QWidget *parent) :
     ui->_selectedListView->setAutoScroll(true);
     ui->_messageLabel->setHidden(true);    
 
-    // Signals for Reordering
-    /*
-     * The strategy here is using the dropEvent from the QListView, and then connect to the inserted/removed signals
-     * for managing the _selectedListIndex.
-    */
-    connect(&_selectedItemModel,&QStandardItemModel::rowsInserted,this,&AddRemoveSelection::onSelectedListRowsInserted);
-    connect(&_selectedItemModel,&QStandardItemModel::rowsRemoved,this,&AddRemoveSelection::onSelectedListRowsRemoved);
+    // Renames from the editor and moves of rows go through the undo stack
+    connect(&_selectedItemModel,&SelectedListModel::renameRequested,this,&AddRemoveSelection::onSelectedListRenameRequested);
+    connect(&_selectedItemModel,&SelectedListModel::moveRequested,this,&AddRemoveSelection::onSelectedListMoveRequested);
     // Check drap / drop event signals without reimplementing the event functions
     ui->_selectedListView->viewport()->installEventFilter(this);
     ui->_availableListView->viewport()->installEventFilter(this);
     // Check edit finish signal for renaming event
     connect(ui->_selectedListView->itemDelegate(), &QAbstractItemDelegate::closeEditor, this, &AddRemoveSelection::onSelectedViewEditEnd);
+    // Undo / redo shortcuts while the focus is in the widget
+    QAction *undoAction = _undoStack.createUndoAction(this);
+    undoAction->setShortcut(QKeySequence::Undo);
+    undoAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    addAction(undoAction);
+    QAction *redoAction = _undoStack.createRedoAction(this);
+    redoAction->setShortcut(QKeySequence::Redo);
+    redoAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    addAction(redoAction);
 }
 
 AddRemoveSelection::~AddRemoveSelection()
 {
+    // Nothing is reported while the widget is destroyed. The loaders are stopped and their
+    // threads joined before the members go away. A thread whose loader has finished may still
+    // wait for its queued quit(), so it's asked to quit directly.
+    blockSignals(true);
+    cancelLoading();
+    for (const QPointer<QThread> &thread : _loaderThreads) {
+        if (thread) {
+            thread->quit();
+            thread->wait();
+        }
+    }
+    _engine.removeObserver(this);
     delete ui;
 }
 
 void AddRemoveSelection::setFullListCheckbox(bool checked) {
-    ui->_fullListCheckBox->setChecked(checked);    
+    _engine.setFullListShown(checked);
+    updateFullListCheckBox();
 }
 
 void AddRemoveSelection::setFullList (const QStringList &fullList) {    
-    _fullList = fullList;
-    _tooltipList.clear();
-    _shortListIndex.clear();
-    populateAvailableList();
+    _undoStack.clear(); // The commands refer to the index of the previous full list
+    _engine.setFullList(fullList);
 }
 
 void AddRemoveSelection::setFullList(const QStringList &fullList, const QStringList &tooltipList) {
-    _fullList = fullList;
-    _tooltipList.clear();
-    if (tooltipList.size() == fullList.size()) {
-        _tooltipList = tooltipList;
-    }
-    _shortListIndex.clear();
-    populateAvailableList();
+    _undoStack.clear(); // The commands refer to the index of the previous full list
+    _engine.setFullList(fullList, tooltipList);
 }
 
 void AddRemoveSelection::setFullList(const QStringList &fullList, const QStringList &tooltipList, const std::vector<unsigned int> &listIndex) {
-    _fullList = fullList;
-    _tooltipList.clear();
-    if (tooltipList.size() == fullList.size()) {
-        _tooltipList = tooltipList;
-    }
-    setShortListIndex(listIndex);
+    _undoStack.clear(); // The commands refer to the index of the previous full list
+    _engine.setFullList(fullList, tooltipList, listIndex);
+}
+
+void AddRemoveSelection::setCatalog(const Util::Catalog &catalog) {
+    _undoStack.clear(); // The commands refer to the index of the previous full list
+    _engine.setCatalog(catalog);
+}
+
+void AddRemoveSelection::setCatalog(const Util::Catalog &catalog, const std::vector<unsigned int> &listIndex) {
+    _undoStack.clear(); // The commands refer to the index of the previous full list
+    _engine.setCatalog(catalog, listIndex);
+}
+
+void AddRemoveSelection::appendFullList(const QStringList &fullList, const QStringList &tooltipList, const std::vector<unsigned int> &listIndex) {
+    _engine.appendFullList(fullList, tooltipList, listIndex);
+}
+
+void AddRemoveSelection::reloadFullList(const QStringList &fullList, const QStringList &tooltipList, const std::vector<unsigned int> &listIndex) {
+    _undoStack.clear(); // The commands refer to the index of the previous full list
+    _engine.reloadFullList(fullList, tooltipList, listIndex);
 }
 
 void AddRemoveSelection::setShortListIndex(const std::vector<unsigned int> &listIndex) {
-    _shortListIndex = listIndex;
-    // Remove duplicate elements and sort
-    std::sort(_shortListIndex.begin(), _shortListIndex.end());
-    _shortListIndex.erase(std::unique( _shortListIndex.begin(), _shortListIndex.end() ), _shortListIndex.end());
-    // Remove out of bound index
-    _shortListIndex.erase(std::find_if(_shortListIndex.begin(),_shortListIndex.end(),
-                    std::bind2nd(std::greater<unsigned int>(),_fullList.size()-1)),
-                    _shortListIndex.end());
-    // Display the checkbox if we do need to switch between lists
-     if ((_shortListIndex.size() != unsigned(_fullList.size())) && !_fullList.empty()) {
-         ui->_fullListCheckBox->setHidden(false);
-         ui->_fullListCheckBox->setChecked(false);
-     }
-     populateAvailableList();
+    _engine.setShortListIndex(listIndex);
 }
 
 QStringList AddRemoveSelection::getShortList() {
-    return reducedListByIndex(_fullList,_shortListIndex);
+    return reducedListByIndex(_engine.catalog(), _engine.shortListIndex());
+}
+
+void AddRemoveSelection::setViewsFromTooltips(bool enabled) {
+    _engine.setViewsFromTooltips(enabled);
+}
+
+int AddRemoveSelection::addView(const QString &name, const std::vector<unsigned int> &index) {
+    return _engine.addView(name, index);
+}
+
+void AddRemoveSelection::setCurrentView(int view) {
+    _engine.setCurrentView(view);
 }
 
 void AddRemoveSelection::readListFromFile(const QString &filename) {
-    QStringList sList_raw, sList_alias;
-    readSelectedItemsListFromFile(filename, sList_raw, sList_alias);
-    loadSelectedItemsFromLists(sList_raw, sList_alias);
+    cancelLoading();
+    int status = _engine.readListFromFile(filename);
+    if (status != Util::ListFileLoader::NoError) {
+        showLoadError(status);
+        return;
+    }
+    _undoStack.clear(); // The loaded list can't be undone to the previous one
 }
 
-void AddRemoveSelection::readSelectedItemsListFromFile(const QString &filename, QStringList &sList_raw, QStringList &sList_alias) {
-    int status = Util::ListCsvProcessor::read(filename,sList_raw,sList_alias);
-    if (status != 0){
+/*
+ * The loader runs on its own thread and only reports back through queued signals. The thread
+ * quits when the loader finishes, and both are deleted once the thread has stopped, so the
+ * loader is still alive when onListFileLoaded() runs. A cancelled loader is only detached: it
+ * stops at its next check and cleans itself up the same way.
+*/
+void AddRemoveSelection::readListFromFileAsync(const QString &filename) {
+    cancelLoading();
+    QThread *thread = new QThread();
+    Util::ListFileLoader *loader = new Util::ListFileLoader(filename, _engine.catalog(), _engine.fullListFingerprint());
+    loader->moveToThread(thread);
+    connect(thread, &QThread::started, loader, &Util::ListFileLoader::process);
+    connect(loader, &Util::ListFileLoader::progress, this, &AddRemoveSelection::onListFileProgress);
+    connect(loader, &Util::ListFileLoader::finished, this, &AddRemoveSelection::onListFileLoaded);
+    connect(loader, &Util::ListFileLoader::finished, thread, &QThread::quit);
+    connect(thread, &QThread::finished, loader, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    _fileLoader = loader;
+    _loaderThreads.removeAll(QPointer<QThread>()); // The threads already deleted
+    _loaderThreads << thread;
+    thread->start();
+}
+
+void AddRemoveSelection::cancelLoading() {
+    if (_fileLoader) {
+        _fileLoader->cancel();
+        _fileLoader = nullptr;
+        emit loadFinished(false);
+    }
+}
+
+void AddRemoveSelection::showLoadError(int status) {
+    if (status == Util::ListFileLoader::FormatError) {
+        QMessageBox::critical(this,"Error", "Failed to load file! Each line must have two comma separated values.");
+    }
+    else if (status != Util::ListFileLoader::NoError && status != Util::ListFileLoader::Cancelled) {
         QMessageBox::critical(this,"Error", "Failed to load file!");
     }
 }
 
 void AddRemoveSelection::saveSelectedItemsListToFile(const QString &filename) {
-    QStringList sList_raw = getSelectedItemsList(true);
-    QStringList sList_alias = getSelectedItemsList(false);
-    int status = Util::ListCsvProcessor::write(filename, sList_raw, sList_alias);
+    int status = _engine.saveListToFile(filename);
     if (status != 0) {
         QMessageBox::critical(this,"Error", "Failed to save file!");
     }
 }
 
-void AddRemoveSelection::loadSelectedItemsFromLists(const QStringList &sList_raw, const QStringList &sList_alias) {
-    // Clear selection
-    _selectedListIndex.clear();
-    _selectedItemModel.clear();
-    // Arrange selected items
-    for (int idx = 0 ; idx < sList_raw.size() ; ++idx) {
-        int nIndex = _fullList.indexOf(sList_raw.at(idx));
-        if (nIndex != -1) {
-            // Store index
-            _selectedListIndex.push_back(unsigned(nIndex));
-            // Add items
-            QStandardItem* selectedItem = new QStandardItem();
-            selectedItem->setDropEnabled(false);
-            selectedItem->setToolTip(sList_raw.at(idx));
-            QString varName = sList_alias.at(idx);
-            if (_validNameCheck) {
-                makeUnderscoreVar(varName);
-            }
-            selectedItem->setText(varName);
-            _selectedItemModel.insertRow(idx, selectedItem);
-        }
-    }
-    populateAvailableList();
-    // Show warning message
-    if (!_selectedListIndex.empty() && _validNameCheck) {
-        ui->_messageLabel->setHidden(false);
+void AddRemoveSelection::saveSnapshotToFile(const QString &filename) {
+    Util::TraceSpan span("AddRemoveSelection::saveSnapshotToFile");
+    span.setItems(_engine.selectedCount());
+    int status = _engine.saveSnapshotToFile(filename);
+    if (status != 0) {
+        QMessageBox::critical(this,"Error", "Failed to save file!");
     }
-    else {
-        ui->_messageLabel->setHidden(true);
+}
+
+void AddRemoveSelection::loadSelectedItemsFromLists(const QStringList &sList_raw, const QStringList &sList_alias) {
+    _undoStack.clear(); // The loaded list can't be undone to the previous one
+    _engine.loadItemsFromLists(sList_raw, sList_alias);
+}
+
+void AddRemoveSelection::loadSelectedItems(const std::vector<unsigned int> &index, const QStringList &sList_alias) {
+    _undoStack.clear(); // The loaded list can't be undone to the previous one
+    _engine.loadItems(index, sList_alias);
+}
+
+int AddRemoveSelection::setJournalFile(const QString &filename) {
+    if (filename.isEmpty()) {
+        _journal.close();
+        return Engine::SelectionJournal::NoError;
     }
+    return _journal.open(filename);
+}
+
+int AddRemoveSelection::recoverJournal(const QString &filename) {
+    _undoStack.clear(); // The recovered list can't be undone to the previous one
+    return _journal.recover(filename);
 }
 
 QStringList AddRemoveSelection::getSelectedItemsList(bool raw) {
     if (raw) { // Original names
-        return reducedListByIndex(_fullList,_selectedListIndex);
+        return _engine.selectedRawList();
     }
     else { // Alias names
-        QStringList selectedList;
-        int nRow = ui->_selectedListView->model()->rowCount();
-        for (int idx = 0 ; idx < nRow ; ++idx){
-            selectedList << ui->_selectedListView->model()->index(idx,0).data().toString();
-        }
-        return selectedList;
+        return _engine.selectedAliasList();
     }
 }
 
 void AddRemoveSelection::setTooltips(const QStringList &tooltipList) {
-    // If size doesn't match, remove the tooltips.
-    if (_tooltipList.size() != _fullList.size()) {
-        _tooltipList.clear();
-    }
-    else {
-        _tooltipList = tooltipList;
-    }
-    populateAvailableList();
+    _engine.setTooltips(tooltipList);
 }
 
 void AddRemoveSelection::setValidNameCheck(bool state) {
-    _validNameCheck = state;
+    _engine.setValidNameCheck(state);
+}
+
+void AddRemoveSelection::setNamingPolicy(const Util::NamingPolicy &policy) {
+    _engine.setNamingPolicy(policy);
 }
 
 void AddRemoveSelection::on__fullListCheckBox_clicked() {
-    populateAvailableList();
+    _engine.setFullListShown(ui->_fullListCheckBox->isChecked());
+}
+
+void AddRemoveSelection::on__viewComboBox_activated(int index) {
+    _engine.setCurrentView(ui->_viewComboBox->itemData(index).toInt());
 }
 
 void AddRemoveSelection::on__addItemButton_clicked() {
     if (ui->_availableListView->selectionModel()->hasSelection()){
-        addItems(ui->_availableListView->selectionModel()->selectedIndexes()); // Must use selectionModel()
+        addItems(ui->_availableListView->selectionModel()->selection()); // Must use selectionModel()
     }
 }
 
 void AddRemoveSelection::on__removeItemButton_clicked() {
     if (ui->_selectedListView->selectionModel()->hasSelection()) {        
-        removeItems(ui->_selectedListView->selectionModel()->selectedIndexes());        
+        removeItems(ui->_selectedListView->selectionModel()->selection());
     }
 }
 
 void AddRemoveSelection::on__reset_clicked() {    
-    _selectedListIndex.clear();
-    _selectedItemModel.clear();
-    populateAvailableList();
+    // The reset removes all the items through the undo stack, so it can be undone
+    if (_engine.selectedCount() > 0) {
+        int lastRow = int(_engine.selectedCount()) - 1;
+        _undoStack.push(new RemoveItemsCommand(&_engine, std::vector<std::pair<int,int>>(1, std::make_pair(0, lastRow))));
+    }
     ui->_messageLabel->setHidden(true);
     ui->_availableListView->scrollToTop();
 }
 
 void AddRemoveSelection::on__availableListView_doubleClicked(const QModelIndex &index) {
-    addItems(QModelIndexList({index}));
+    addItems(QItemSelection(index, index));
 }
 
 void AddRemoveSelection::on__loadListButton_clicked() {
     QString setFilter = "Comma-Separated Values File (*.csv)";
-    QString filter = setFilter + ";; All files (*.*)";
+    QString filter = setFilter + ";; Selection Snapshot File (*.arss);; All files (*.*)";
     QFileDialog loadDlg(this);
     loadDlg.setNameFilter(filter);
     loadDlg.selectNameFilter(setFilter);
@@ -246,15 +313,24 @@ void AddRemoveSelection::on__loadListButton_clicked() {
     if (loadDlg.exec() && !loadDlg.selectedFiles().isEmpty()) {
         QUrl url = loadDlg.selectedUrls().back();
         if (url.isValid()) {
-            readListFromFile(url.toLocalFile());
+            // Keep the GUI responsive while a large file is loading, and let the user cancel it
+            QProgressDialog *progressDlg = new QProgressDialog("Loading selected signals ...", "Cancel", 0, 100, this);
+            progressDlg->setWindowModality(Qt::WindowModal);
+            progressDlg->setMinimumDuration(500);
+            progressDlg->setAttribute(Qt::WA_DeleteOnClose);
+            connect(this, &AddRemoveSelection::loadProgress, progressDlg, &QProgressDialog::setValue);
+            connect(this, &AddRemoveSelection::loadFinished, progressDlg, &QProgressDialog::close);
+            connect(progressDlg, &QProgressDialog::canceled, this, &AddRemoveSelection::cancelLoading);
+            readListFromFileAsync(url.toLocalFile());
         }
     }
 }
 
 void AddRemoveSelection::on__saveListButton_clicked() {
-    if (_selectedListIndex.size() > 0) {
+    if (_engine.selectedCount() > 0) {
         QString setFilter = "Comma-Separated Values File (*.csv)";
-        QString filter = setFilter + ";; All files (*.*)";
+        QString snapshotFilter = "Selection Snapshot File (*.arss)";
+        QString filter = setFilter + ";; " + snapshotFilter + ";; All files (*.*)";
         QFileDialog saveDlg(this);
         saveDlg.selectFile("item_list.csv");
         saveDlg.setNameFilter(filter);
@@ -264,281 +340,174 @@ void AddRemoveSelection::on__saveListButton_clicked() {
         if (saveDlg.exec() && !saveDlg.selectedFiles().isEmpty()) {
             QUrl url = saveDlg.selectedUrls().front();
             if (url.isValid()) {
-                saveSelectedItemsListToFile(url.toLocalFile());
+                QString filename = url.toLocalFile();
+                if (saveDlg.selectedNameFilter() == snapshotFilter || filename.endsWith(".arss", Qt::CaseInsensitive)) {
+                    saveSnapshotToFile(filename);
+                }
+                else {
+                    saveSelectedItemsListToFile(filename);
+                }
             }
         }
     }
 }
 
-bool AddRemoveSelection::isFullList() {
-    bool isFull = false;
-    if (ui->_fullListCheckBox->isHidden()) {
-        isFull = true;
-    }
-    else if (ui->_fullListCheckBox->isChecked()) {
-        isFull = true;
-    }
-    else {
-        isFull = false;
+void AddRemoveSelection::updateFullListCheckBox() {
+    ui->_fullListCheckBox->setHidden(!_engine.hasShortList());
+    ui->_fullListCheckBox->setChecked(_engine.isFullListShown());
+}
+
+void AddRemoveSelection::updateViewComboBox() {
+    // The first item shows all the items, the others are the views
+    ui->_viewComboBox->clear();
+    ui->_viewComboBox->addItem("All items", -1);
+    const QStringList viewNames = _engine.viewNames();
+    for (int view = 0 ; view < viewNames.size() ; ++view) {
+        ui->_viewComboBox->addItem(viewNames.at(view), view);
     }
-    return isFull;
+    ui->_viewComboBox->setCurrentIndex(_engine.currentView() + 1);
+    ui->_viewComboBox->setHidden(viewNames.isEmpty());
 }
 
-QStringList AddRemoveSelection::reducedListByIndex(const QStringList &fList, const std::vector<unsigned int> index) {
+QStringList AddRemoveSelection::reducedListByIndex(const Util::Catalog &catalog, const std::vector<unsigned int> index) {
     QStringList reducedList;
     for (const unsigned int &idx : index) {
-        if (idx < unsigned(fList.size())) {
-            reducedList << fList.at(int(idx));
+        if (idx < unsigned(catalog.size())) {
+            reducedList << catalog.name(int(idx));
         }
     }
     return reducedList;
 }
 
 void AddRemoveSelection::populateAvailableList() {
-    _availableItemModel.clear();
-    // Preparing the string list
-    QStringList reducedList;
-    QStringList reducedTooltipList;
-    std::vector<unsigned int> unSelectedIndex;
-    std::vector<unsigned int> sortedIndex(_selectedListIndex);
-    unsigned int sIdx = 0;
-    if (!_fullList.isEmpty()) {
-        if (isFullList()) { // Display full list
-            if (_selectedListIndex.empty()) {
-                reducedList = _fullList;
-                reducedTooltipList = _tooltipList;
-            }
-            else {
-                // Construct a index based on selected item index
-                std::sort(sortedIndex.begin(),sortedIndex.end());
-                // Create a index with only required item
-                for (unsigned int idx = 0 ; idx < unsigned(_fullList.size()) ; ++ idx) {
-                    if (!sortedIndex.empty() && (sIdx < sortedIndex.size())) {
-                        if (idx == sortedIndex.at(sIdx)) {
-                            sIdx++;
-                            continue;
-                        }
-                    }
-                    unSelectedIndex.push_back(idx);
-                }
-                reducedList = reducedListByIndex(_fullList,unSelectedIndex);
-                if (!_tooltipList.empty()) {
-                    reducedTooltipList = reducedListByIndex(_tooltipList,unSelectedIndex);
-                }
-            }
-        }
-        else { // Short list
-            // It will be easier to use find since we've had the index for the short list.
-            unSelectedIndex = _shortListIndex;
-            std::sort(sortedIndex.begin(),sortedIndex.end(),std::greater<unsigned int>());
-            for (const auto &idx : sortedIndex) {
-                auto result = std::find(unSelectedIndex.begin(),unSelectedIndex.end(),idx);
-                if (result != unSelectedIndex.end()) {
-                    unSelectedIndex.erase(result);
-                }
-            }
-            reducedList = reducedListByIndex(_fullList,unSelectedIndex);
-            if (!_tooltipList.empty()) {
-                reducedTooltipList = reducedListByIndex(_tooltipList,unSelectedIndex);
-            }
-        }
-        // Now prepare the items for model
-        QList<QStandardItem*> itemList;
-        for (auto idx = 0 ; idx < reducedList.size() ; ++idx) {
-            QStandardItem* item = new QStandardItem(reducedList.at(idx));
-            item->setDropEnabled(false);
-            if (!reducedTooltipList.empty()) {
-                item->setData(reducedTooltipList.at(idx), Qt::ToolTipRole);
-            }
-            itemList << item;
-        }
-        _availableItemModel.appendColumn(itemList);
-    }
+    Util::TraceSpan span("AddRemoveSelection::populateAvailableList");
+    // The model reads the text and tooltip from the full list and the tooltip list by the index
+    _availableItemModel.setRowIndex(_engine.availableIndex());
 }
 
-void AddRemoveSelection::updateSelectedList(const QModelIndexList &selections) {
-    std::vector<unsigned int> backSortedIndex;
-    for (const QModelIndex &idx : selections) {
-        QString escData = QRegularExpression::escape(idx.data().toString());
-        backSortedIndex.push_back(unsigned(_fullList.indexOf(QRegularExpression(escData)))); // Save _fullList index that moved
-    }
-    std::reverse(backSortedIndex.begin(), backSortedIndex.end());
-    for (const unsigned int &idx : backSortedIndex) {
-        _selectedListIndex.push_back(idx);
-    }
-    if (!_selectedListIndex.empty() && _validNameCheck) {
-        ui->_messageLabel->setHidden(false);
+void AddRemoveSelection::updateAvailableList() {
+    Util::TraceSpan span("AddRemoveSelection::updateAvailableList");
+    // Only the rows that differ from the current available list are removed or inserted
+    _availableItemModel.updateRowIndex(_engine.availableIndex());
+}
+
+std::vector<std::pair<int,int>> AddRemoveSelection::selectionRuns(const QItemSelection &selection) {
+    std::vector<std::pair<int,int>> ranges;
+    for (const QItemSelectionRange &range : selection) {
+        if (range.isValid()) {
+            ranges.push_back(std::make_pair(range.top(), range.bottom()));
+        }
     }
-    else {
-        ui->_messageLabel->setHidden(true);
+    std::sort(ranges.begin(), ranges.end());
+    // Merge the ranges which overlap or touch each other
+    std::vector<std::pair<int,int>> runs;
+    for (const auto &range : ranges) {
+        if (!runs.empty() && range.first <= runs.back().second + 1) {
+            runs.back().second = std::max(runs.back().second, range.second);
+        }
+        else {
+            runs.push_back(range);
+        }
     }
+    return runs;
 }
 
-void AddRemoveSelection::addItems(const QModelIndexList &selections) {
+void AddRemoveSelection::addItems(const QItemSelection &selection) {
+    Util::TraceSpan span("AddRemoveSelection::addItems");
     ui->_availableListView->setAutoScroll(false);
-    QModelIndexList leftSelections = selections;
-    // Get the order of index reserve sorted so it can be removed from the left list correctly.
-    // Unfortunately, std::greater<QModelIndex> doesn't work in this case so I use a lambda function instead;
-    std::sort(leftSelections.begin(), leftSelections.end(),
-              [](const QModelIndex &a, const QModelIndex &b) { return b < a; });
-    updateSelectedList(leftSelections);
-    unsigned int rowCount = unsigned(_selectedItemModel.rowCount());
-    // Prepare items to be added
-    for (const QModelIndex &idx : leftSelections) {
-        QString varName = idx.data().toString(); // Copy the item
-        //qDebug() << varName;
-        QStandardItem* selectedItem = new QStandardItem();
-        selectedItem->setDropEnabled(false);
-        if (_validNameCheck) {
-            selectedItem->setToolTip(varName); // Tooltip is available on when the item name might be changed
-            makeUnderscoreVar(varName);
+    std::vector<std::pair<int,int>> runs = selectionRuns(selection);
+    std::vector<unsigned int> movedIndex;
+    for (const auto &run : runs) {
+        for (int row = run.first ; row <= run.second ; ++row) {
+            movedIndex.push_back(_availableItemModel.fullListIndex(row));
         }
-        selectedItem->setText(varName);
-        _selectedItemModel.insertRow(int(rowCount), selectedItem);
-        _availableItemModel.removeRow(idx.row()); // Remove from the highest order
-    }    
+    }
+    span.setItems(qint64(movedIndex.size()));
+    // The items are appended through the undo stack
+    if (!movedIndex.empty()) {
+        _undoStack.push(new AddItemsCommand(&_engine, int(_engine.selectedCount()), movedIndex));
+    }
     ui->_availableListView->setAutoScroll(true);
 }
 
-void AddRemoveSelection::removeItems(const QModelIndexList &selections) {
+void AddRemoveSelection::removeItems(const QItemSelection &selection) {
+    Util::TraceSpan span("AddRemoveSelection::removeItems");
     ui->_selectedListView->setAutoScroll(false);
-    QModelIndexList rightSelections = selections;
-    std::vector<unsigned int> tempInsertedIndex;
-    // Add items back to the left panel
-    for (const QModelIndex &idx : rightSelections) {
-        unsigned int rowIdx = unsigned(idx.row());
-        if (!isFullList() && // If a selected-to-remove item was not exist in the short list and the left panel is showing the short list
-                             // we quickly skip the index because it doesn't need shown.
-            !std::binary_search(_shortListIndex.begin(),_shortListIndex.end(), _selectedListIndex.at(rowIdx))) {
-            continue;
-        }
-        else { // Once we know it needs to be added back to the left panel, we find the next available location (based on its originated order)
-               // in the left panel and insert it.
-            tempInsertedIndex.push_back(_selectedListIndex.at(rowIdx));
-            unsigned int rowNum = findNextRowInAvailableList(_selectedListIndex.at(rowIdx), tempInsertedIndex);
-            QString itemText = _fullList.at(int(_selectedListIndex.at(rowIdx)));
-            _availableItemModel.insertRow(int(rowNum), new QStandardItem(itemText));
-        }
+    std::vector<std::pair<int,int>> runs = selectionRuns(selection);
+    qint64 nItem = 0;
+    for (const auto &run : runs) {
+        nItem += run.second - run.first + 1;
+    }
+    span.setItems(nItem);
+    // The items are removed through the undo stack
+    if (!runs.empty()) {
+        _undoStack.push(new RemoveItemsCommand(&_engine, runs));
     }
-    std::sort(rightSelections.begin(), rightSelections.end(),
-              [](const QModelIndex &a, const QModelIndex &b) { return b < a; });
-    for (auto idx = 0 ; idx < rightSelections.size() ; ++idx) {
-        int rowNum = rightSelections.at(idx).row();
-        _selectedListIndex.erase(_selectedListIndex.begin() + rowNum);
-        _selectedItemModel.removeRow(rowNum);
+    ui->_availableListView->selectionModel()->select(ui->_availableListView->indexAt(
+                        ui->_availableListView->viewport()->pos()),QItemSelectionModel::Select);
+    ui->_selectedListView->setAutoScroll(false);
+}
+
+void AddRemoveSelection::reorderItems(const std::vector<int> &fromRows, int destRow) {
+    Util::TraceSpan span("AddRemoveSelection::reorderItems");
+    span.setItems(qint64(fromRows.size()));
+    // The dragged rows are taken out first, so the ones above the drop row move it up
+    int movedAbove = 0;
+    for (const int &row : fromRows) {
+        movedAbove += (row < destRow) ? 1 : 0;
     }
-    // Show warning message
-    if (!_selectedListIndex.empty() && _validNameCheck) {
+    std::vector<int> toRows;
+    for (unsigned int pos = 0 ; pos < fromRows.size() ; ++pos) {
+        toRows.push_back(destRow - movedAbove + int(pos));
+    }
+    if (!fromRows.empty() && toRows != fromRows) {
+        _undoStack.push(new ReorderItemsCommand(&_engine, fromRows, toRows));
+    }
+}
+
+void AddRemoveSelection::showNameCheckMessage() {
+    if (_engine.selectedCount() > 0 && _engine.validNameCheck()) {
         ui->_messageLabel->setHidden(false);
     }
     else {
         ui->_messageLabel->setHidden(true);
     }
-    ui->_availableListView->selectionModel()->select(ui->_availableListView->indexAt(
-                        ui->_availableListView->viewport()->pos()),QItemSelectionModel::Select);
-    ui->_selectedListView->setAutoScroll(false);
 }
 
-unsigned int AddRemoveSelection::findNextRowInAvailableList(unsigned int rowNum, std::vector<unsigned int> tempIndex) {
-    // To put back the item to the left listview with the original position in the full list
-    // First, put to the end if the item is the last in the _fulllist
-    if (rowNum == ((isFullList()) ? unsigned(_fullList.size())-1 : _shortListIndex.back())) {
-        rowNum = unsigned(_availableItemModel.rowCount());
-    }
-    // Second, if nothing in the left listview, put the item at the first row.
-    else if (_availableItemModel.rowCount() == 0) {
-        rowNum = 0;
-    }
-    // Otherwise...
-    else if (rowNum != 0) {
-        // First, we find the next available index in the stored vector
-        unsigned int nextRowNum = rowNum;
-        for (unsigned int pIdx = 1 ; pIdx < (unsigned(_fullList.size()) - rowNum) ; ++pIdx) {
-            if (!isFullList() &&
-                !std::binary_search(_shortListIndex.begin(),_shortListIndex.end(),rowNum+pIdx)) {
-                continue;
-            }
-            else {
-                // Check the log that has been moved back to left listview
-                bool foundInTempIndex = (std::find(tempIndex.begin(), tempIndex.end(), rowNum+pIdx) != tempIndex.end());
-                // Then check the current _selectedListIndex. The value at the left shouldn't exist.
-                bool foundInSelectedListIndex = (std::find(_selectedListIndex.begin(), _selectedListIndex.end(), rowNum+pIdx) != _selectedListIndex.end());
-                // Iterate the index until we found the next nearest item (in the _fulllist) at the left listview.
-                if (foundInTempIndex || !foundInSelectedListIndex) {
-                    nextRowNum = rowNum + pIdx;
-                    break;
-                }
-            }
-        }
-        // If the item index is the largest comparing to the item in the left listview, put it at the end.
-        if (nextRowNum == rowNum) {
-            rowNum = unsigned(_availableItemModel.rowCount());
-        }
-        // Otherwise, look for the next available location in the left listview based on previous search
-        // result, use the result to insert the item.
-        else {
-            QList<QStandardItem*> foundItems = _availableItemModel.findItems(_fullList.at(int(nextRowNum)));
-            rowNum = unsigned(_availableItemModel.indexFromItem(foundItems.front()).row());
-        }
-    }
-    return rowNum;
+int AddRemoveSelection::findNextRowInAvailableList(unsigned int fullIndex) const {
+    Util::TraceSpan span("AddRemoveSelection::findNextRowInAvailableList");
+    // To put back the item to the left listview with the original position in the full list.
+    // The rows of the available list are kept in the full list order, so the position is the
+    // number of rows with a smaller full list index, i.e. the rank of the index among the items
+    // in the left listview. Items which are not shown (selected, or not in the short list) are
+    // simply not counted, so there is no need to look them up.
+    return _availableItemModel.rowOfIndex(fullIndex);
 }
 
-void AddRemoveSelection::checkItemNameError(QStandardItem *item) {
-    QString itemText = item->text();
+void AddRemoveSelection::checkItemNameError(int row) {
+    QString itemText = _engine.alias(row);
     QString message = "";
     // Search for duplicate
-    if (_selectedItemModel.findItems(itemText).size()>1) {
-        QString newItemText = duplicateNameHandler(itemText);
+    if (_engine.aliasCount(itemText) > 1) {
+        QString newItemText = _engine.uniqueAlias(itemText);
         message += "<b>\"" + itemText + "\"</b> will be replace with <b>\"" + newItemText + "\"</b>";
         message = "<b>Duplicate name found!</b><br><br>" + message;
         messageBox(message);
-        item->setText(newItemText);
+        _undoStack.push(new RenameItemCommand(&_engine, row, itemText, newItemText));
     }
     // Force to replace with valid name if necessary
-    else if (_validNameCheck) {
-        QString validText = itemText;
-        if (itemText.indexOf(QRegularExpression("[^a-zA-Z0-9_]")) != -1) {
-            makeUnderscoreVar(validText);
+    else if (_engine.validNameCheck()) {
+        QString validText = _engine.validAlias(itemText);
+        if (validText != itemText) {
             message += "<b>\"" + itemText + "\"</b> will be replaced with <b>\"" + validText + "\"</b>";
-            message = "<b>Name is invalid! Specail characters will be replaced with \"_\"</b><br><br>" + message;
+            message = "<b>Name is invalid! Specail characters will be replaced with \"" +
+                      QString(_engine.namingPolicy().replacement()).toHtmlEscaped() + "\"</b><br><br>" + message;
             messageBox(message);
-            item->setText(validText);
+            _undoStack.push(new RenameItemCommand(&_engine, row, itemText, validText));
         }
     }
 }
 
-void AddRemoveSelection::makeUnderscoreVar(QString &str) {
-    str.replace(QRegularExpression("[^a-zA-Z0-9_]"), QString("_"));
-}
-
-QString AddRemoveSelection::duplicateNameHandler(const QString &str) {
-    unsigned int idx = 1;
-    QString newStr = str;
-    while (!_selectedItemModel.findItems(newStr).empty()) {
-        newStr = str+QString("_%1").arg(idx);
-        idx++;
-    }
-    return newStr;
-}
-
-AddRemoveSelection::ActionId AddRemoveSelection::currentDragDropAction() {
-    ActionId aId;
-    if (_itemsSelectedInAvailableView & _itemsDropInSelectedView) {
-        aId = ActionId::AddItems;
-    }
-    else if (_itemsSelectedInSelectedView & _itemsDropInAvailableView) {
-        aId = ActionId::RemoveItems;
-    }
-    else if (_itemsSelectedInSelectedView & _itemsDropInSelectedView) {
-        aId = ActionId::ReorderItems;
-    }
-    else {
-        aId = ActionId::NoAction;
-    }
-    return aId;
-}
-
 void AddRemoveSelection::messageBox(const QString &title, QMessageBox::Icon icon) {
     QMessageBox msgBox;
     msgBox.setText(title);
@@ -550,104 +519,156 @@ void AddRemoveSelection::messageBox(const QString &title, QMessageBox::Icon icon
 
 /*
  * The event filter is installed to QListView::viewport for identifying events.
+ * Every drop between or within the views is applied to the engine through the undo stack,
+ * and the drop action is ignored afterward so that neither of the views moves the items again.
 */
 bool AddRemoveSelection::eventFilter(QObject *object, QEvent *event) {
     /* Use for tracking events */
 //        qDebug() << object->objectName();
 //        qDebug() << object->parent()->objectName();
 //        qDebug() << event->type();
+    if (event->type() == QEvent::Paint && Util::Trace::isEnabled()) {
+        // Marks where the views repaint between the spans
+        Util::Trace::instant((object == ui->_availableListView->viewport()) ? "availableListView.paint" : "selectedListView.paint");
+    }
     if (object == ui->_availableListView->viewport() && event->type() == QEvent::Drop) {
-        _itemsDropInAvailableView = true;
-        _itemsDropInSelectedView = false;
+        // Items dragged from the selected view are put back through removeItems()
+        QDropEvent *dropEvent = static_cast<QDropEvent*>(event);
+        if (dropEvent->source() == ui->_selectedListView) {
+            removeItems(ui->_selectedListView->selectionModel()->selection());
+            dropEvent->setDropAction(Qt::IgnoreAction);
+        }
     }
     else if (object == ui->_selectedListView->viewport() && event->type() == QEvent::Drop) {
-        _itemsDropInAvailableView = false;
-        _itemsDropInSelectedView = true;
-    }
-    else if (object == ui->_availableListView->viewport() && event->type() == QEvent::MouseButtonPress) {
-        _itemsSelectedInAvailableView = true;
-        _itemsSelectedInSelectedView = false;
-    }
-    else if (object == ui->_selectedListView->viewport() && event->type() == QEvent::MouseButtonPress) {
-        _itemsSelectedInAvailableView = false;
-        _itemsSelectedInSelectedView = true;
+        // Same as above, items dragged from the available view are added through addItems()
+        QDropEvent *dropEvent = static_cast<QDropEvent*>(event);
+        if (dropEvent->source() == ui->_availableListView) {
+            addItems(ui->_availableListView->selectionModel()->selection());
+            dropEvent->setDropAction(Qt::IgnoreAction);
+        }
+        else if (dropEvent->source() == ui->_selectedListView) {
+            // Reorder. The items go in front of the item under the cursor, or after it when the
+            // cursor is on its lower half, or at the end below the last item. The rows are moved
+            // here, before the view gets the drop, and the ignored action keeps the view from
+            // dropping the data itself, so nothing is left to clear once the event is handled.
+            int destRow = _selectedItemModel.rowCount();
+            QModelIndex target = ui->_selectedListView->indexAt(dropEvent->pos());
+            if (target.isValid()) {
+                QRect rect = ui->_selectedListView->visualRect(target);
+                destRow = (dropEvent->pos().y() < rect.center().y()) ? target.row() : target.row() + 1;
+            }
+            std::vector<int> fromRows;
+            for (const auto &run : selectionRuns(ui->_selectedListView->selectionModel()->selection())) {
+                for (int row = run.first ; row <= run.second ; ++row) {
+                    fromRows.push_back(row);
+                }
+            }
+            reorderItems(fromRows, destRow);
+            dropEvent->setDropAction(Qt::IgnoreAction);
+        }
     }
     return QObject::eventFilter(object, event);
 }
 
-/*
- * The QStandardItemModel::rowsInserted and QStandardItemModel::rowsRemoved SIGNALs
- * would be triggered when the reordering happens because the reorder wasn't
- * implemented as take out/put back, and yet it's an insert and delete process.
- * The purpose of implementing methods in both event is because we have to maintain
- * the _selectedListIndex which store the vector of index for selected items. *
-*/
+void AddRemoveSelection::availableListReset() {
+    updateFullListCheckBox();
+    populateAvailableList();
+}
 
+void AddRemoveSelection::availableListChanged() {
+    updateFullListCheckBox();
+    ui->_viewComboBox->setCurrentIndex(_engine.currentView() + 1);
+    updateAvailableList();
+}
+
+void AddRemoveSelection::availableViewsChanged() {
+    updateViewComboBox();
+}
+
+void AddRemoveSelection::availableIndexesAppended(const std::vector<unsigned int> &index) {
+    _availableItemModel.appendRowIndex(index);
+}
 
 /*
- * When drag/drop reordering is in process, one of the issues of adding the index is
- * that we don't know where it's been moved from. However, I realize that, the
- * QListView::selectionModel has that information. I guess there might be other
- * approach to gain that information but this is the best I can think of. The
- * input arguments of this SLOT has no parent (parent.raw() == -1, and
- * parent == QModelIndex()) in this case. I used the first position and the number of
- * about-to-insert items (last-first+1) to find where to insert in the
- * `_selectedListIndex`. One thing I learned is that the return values of
- * selectedIndexes() could have two conditions. For one is when the selected item with
- * row index >= first; the other case is row < first. The indexes got expended due to
- * the inserted items. The actual position of the originated selected item must account
- * for that. Also the inserted items are sorted in the QListView.
+ * The items go back to the left panel at their original order in the full list. We find the
+ * next available location for each item, and the items sharing the same location are inserted
+ * together.
 */
-void AddRemoveSelection::onSelectedListRowsInserted(const QModelIndex &parent, int first, int last) {
-    (void)parent;
-    if (currentDragDropAction()==ActionId::ReorderItems) {
-        _numOfMovedItem = unsigned(last - first +1);
-        std::vector<unsigned int> itemIndexToBeInsert;
-        for (const QModelIndex &index : ui->_selectedListView->selectionModel()->selectedIndexes()) {
-            unsigned int rowIdx = unsigned(index.row());
-            if (index.row() < first) {
-                itemIndexToBeInsert.push_back(_selectedListIndex.at(rowIdx));
-            }
-            else {
-                itemIndexToBeInsert.push_back(_selectedListIndex.at(rowIdx-_numOfMovedItem));
-            }
+void AddRemoveSelection::availableIndexesInserted(const std::vector<unsigned int> &index) {
+    std::vector<int> returnedRow;
+    std::vector<unsigned int> insertedIndex;
+    for (const unsigned int &fullIndex : index) {
+        int rowNum = findNextRowInAvailableList(fullIndex);
+        if (rowNum < _availableItemModel.rowCount() && _availableItemModel.fullListIndex(rowNum) == fullIndex) {
+            continue; // Already in the left panel
         }
-         std::sort(itemIndexToBeInsert.begin(),itemIndexToBeInsert.end()); // TODO: why do we need to sort?
-        _selectedListIndex.insert(_selectedListIndex.begin()+first,
-                    itemIndexToBeInsert.begin(),itemIndexToBeInsert.end());
+        returnedRow.push_back(rowNum);
+        insertedIndex.push_back(fullIndex);
     }
+    _availableItemModel.insertIndexes(returnedRow, insertedIndex);
+}
 
+void AddRemoveSelection::availableIndexesRemoved(const std::vector<unsigned int> &index) {
+    _availableItemModel.removeIndexes(index);
 }
 
-/*
- * This might be the final step of drag/drop reorder process. The implementation here is
- * to remove the items which we've previously inserted from _selectedListIndex. The
- * index first here indicates the item indexes that is about to be removed (from first
- *  to last). Becuas we have marked the total number of items about to be removed, we
- * conclude the process when the counter (_numOfMovedItem) reaches 0.
-*/
-void AddRemoveSelection::onSelectedListRowsRemoved(const QModelIndex &parent, int first, int last) {
-    (void)parent;
-    if (currentDragDropAction()==ActionId::ReorderItems) {
-        if (_numOfMovedItem > 0) {
-            if (first == last) {
-                _selectedListIndex.erase(_selectedListIndex.begin()+first);
-            }
-            else {
-                _selectedListIndex.erase(_selectedListIndex.begin()+first,_selectedListIndex.begin()+last+1);
-            }
-            _numOfMovedItem-=unsigned(last-first+1);
-        }
-        // Complete reorder
-        if (_numOfMovedItem == 0) {
-          _numOfMovedItem = 0;
-        }
+void AddRemoveSelection::availableIndexesRenumbered(const std::vector<int> &newIndex) {
+    _availableItemModel.renumberIndexes(newIndex);
+}
+
+void AddRemoveSelection::selectedItemsInserted(int, int) {
+    showNameCheckMessage();
+}
+
+void AddRemoveSelection::selectedItemsRemoved(int, int) {
+    showNameCheckMessage();
+}
+
+void AddRemoveSelection::selectedListReset() {
+    showNameCheckMessage();
+}
+
+void AddRemoveSelection::onSelectedListRenameRequested(int row, const QString &alias) {
+    _undoStack.push(new RenameItemCommand(&_engine, row, _engine.alias(row), alias));
+}
+
+void AddRemoveSelection::onSelectedListMoveRequested(int first, int count, int destRow) {
+    std::vector<int> fromRows;
+    for (int row = first ; row < first + count ; ++row) {
+        fromRows.push_back(row);
+    }
+    reorderItems(fromRows, destRow);
+}
+
+void AddRemoveSelection::onListFileProgress(int percent) {
+    if (sender() == _fileLoader) {
+        emit loadProgress(percent);
+    }
+}
+
+void AddRemoveSelection::onListFileLoaded(int status) {
+    Util::ListFileLoader *loader = qobject_cast<Util::ListFileLoader*>(sender());
+    if (!loader || loader != _fileLoader) {
+        return; // Cancelled or replaced by a newer loading
+    }
+    _fileLoader = nullptr;
+    // The index is only valid for the full list which it was resolved against
+    if (status == Util::ListFileLoader::NoError && loader->fingerprint() != _engine.fullListFingerprint()) {
+        status = Util::ListFileLoader::Cancelled;
     }
+    if (status == Util::ListFileLoader::NoError) {
+        // The whole selection is applied with a single update of the models
+        loadSelectedItems(loader->index(), loader->aliasList());
+    }
+    emit loadFinished(status == Util::ListFileLoader::NoError);
+    showLoadError(status);
 }
 
 void AddRemoveSelection::onSelectedViewEditEnd(QWidget *, QAbstractItemDelegate::EndEditHint) {
-    QStandardItem * item = _selectedItemModel.itemFromIndex(ui->_selectedListView->currentIndex());
-    checkItemNameError(item);
+    QModelIndex current = ui->_selectedListView->currentIndex();
+    if (current.isValid()) {
+        checkItemNameError(current.row());
+    }
 }
 
 }
@@ -9,13 +9,27 @@
 #define ADDREMOVESELECTION_H
 
 #include <vector>
+#include <utility>
 #include <QWidget>
 #include <QStringList>
-#include <QStandardItem>
-#include <qstandarditemmodel.h>
 #include <QAbstractItemDelegate>
+#include <QItemSelection>
+#include <QUndoStack>
+#include <QPointer>
+#include <QThread>
 #include <QMessageBox>
 #include <QDebug>
+#include "AvailableListModel.h"
+#include "SelectedListModel.h"
+#include "ItemDataRole.h"
+#include <Engine/SelectionEngine.h>
+#include <Engine/SelectionJournal.h>
+#include <Engine/SelectionPublisher.h>
+#include <Util/NameSanitizer.h>
+
+namespace Util {
+class ListFileLoader;
+}
 
 namespace Ui {
 class AddRemoveSelection;
@@ -36,12 +50,13 @@ namespace Widgets
  * the selected item list in the right panel.This widget provides many useful ideas
  * for how to implement a widget to which the purpose is similar. It can be easily
  * customized to adapt into another Qt GUI design.
+ * The selection itself is kept by a SelectionEngine, which has no UI. The widget turns the
+ * user actions into undo commands on the engine, and follows the engine as an observer.
 */
 
-class AddRemoveSelection : public QWidget
+class AddRemoveSelection : public QWidget, private Engine::SelectionObserver
 {
     Q_OBJECT
-    enum ActionId {AddItems,RemoveItems,ReorderItems,NoAction};
 
 public:
     explicit AddRemoveSelection(QWidget *parent = nullptr);
@@ -50,7 +65,7 @@ public:
     void setFullListCheckbox (bool checked);
 
     // Return the full list
-    QStringList fullList() const { return _fullList; }
+    QStringList fullList() const { return _engine.fullList(); }
 
     // Set a new full list
     void setFullList (const QStringList &fullList);
@@ -61,6 +76,26 @@ public:
     // Set a new full list with its associated tooltip list and provide an index for a shorter list
     void setFullList (const QStringList &fullList, const QStringList &toolTipList, const std::vector<unsigned int> &listIndex);
 
+    // Use a catalog as the full list. Widgets set with the same catalog share its names and
+    // tooltips instead of each holding a copy, they only keep their own selection and lists.
+    void setCatalog(const Util::Catalog &catalog);
+
+    // Same as above, and provide an index for a shorter list
+    void setCatalog(const Util::Catalog &catalog, const std::vector<unsigned int> &listIndex);
+
+    // Return the catalog of the full list, e.g. to share it with another widget
+    const Util::Catalog &catalog() const { return _engine.catalog(); }
+
+    // Append a chunk to the end of the full list, e.g. while a large list is still being read.
+    // The list index is the index of the whole full list for the items of the chunk which are
+    // in the short list. The available list only grows at its end.
+    void appendFullList(const QStringList &fullList, const QStringList &toolTipList, const std::vector<unsigned int> &listIndex);
+
+    // Replace the full list with a new version of it, e.g. the catalog file changed. The items
+    // are matched by name, so the selection is kept except the items which are gone, and only
+    // the rows that changed are updated in the views. It can't be undone.
+    void reloadFullList(const QStringList &fullList, const QStringList &toolTipList, const std::vector<unsigned int> &listIndex);
+
     // Initialize the short list with the index range of the full list.
     // Some necessary checks makes sure the range respects the full list.
     void setShortListIndex(const std::vector<unsigned int> &listIndex);
@@ -68,17 +103,53 @@ public:
     // Return a QStringlist of the short list (from the index range of the full list)
     QStringList getShortList();
 
+    // Offer one view per distinct tooltip (e.g. the categories) in the view combo box. The
+    // available list can then be narrowed to a view.
+    void setViewsFromTooltips(bool enabled);
+
+    // Add a named view of the full list to the view combo box. Return the view number.
+    int addView(const QString &name, const std::vector<unsigned int> &index);
+
+    // Narrow the available list to a view, -1 for all the items
+    void setCurrentView(int view);
+
     // Read selected signal lists from a CSV file and populate the list
     void readListFromFile(const QString &filename);
 
+    // Same as readListFromFile(), but the file is read on a worker thread. loadProgress() is emitted
+    // while reading and loadFinished() when it's done. Only one loading runs at a time.
+    void readListFromFileAsync(const QString &filename);
+
+    // Return true if a file is being loaded in the background
+    bool isLoading() const { return _fileLoader != nullptr; }
+
+    // Keep the selection in a journal file while it's edited, so it can be recovered after a
+    // crash. The file is rewritten with the current selection. An empty filename stops it.
+    // Return an Engine::SelectionJournal status.
+    int setJournalFile(const QString &filename);
+
+    // Load the selection from a journal file and keep journaling to it. It can't be undone.
+    int recoverJournal(const QString &filename);
+
+    // Return the journal file, empty if none
+    const QString &journalFile() const { return _journal.filename(); }
+
     // Return a list of items that were selected
     QStringList getSelectedItemsList(bool raw = true);
 
+    // Return the selection as it was after the last change. It can be called from any thread,
+    // e.g. by worker threads which need the selected items without going through the widget.
+    std::shared_ptr<const Engine::SelectionState> selectionState() const { return _publisher.current(); }
+
+    // Return the version of the selection state, which increases with every change. It can be
+    // called from any thread.
+    quint64 selectionVersion() const { return _publisher.version(); }
+
     // Return the number of selected items
-    unsigned int getSelectedItemCount () const { return unsigned(_selectedListIndex.size()); }
+    unsigned int getSelectedItemCount () const { return _engine.selectedCount(); }
 
     // Return the list of tooptips.
-    QStringList toolTips() { return _tooltipList ; }
+    QStringList toolTips() { return _engine.tooltipList(); }
 
     // Set the tooltip list. The size of tooltip list is the same as the full list.
     void setTooltips(const QStringList &toolTipList);
@@ -87,81 +158,133 @@ public:
     void setValidNameCheck (bool state);
 
     // Get the underscore auto-replace state
-    bool validNameCheck() const { return _validNameCheck; }
+    bool validNameCheck() const { return _engine.validNameCheck(); }
+
+    // Return the undo stack of the add, remove, reorder and rename actions
+    QUndoStack *undoStack() { return &_undoStack; }
+
+    // Set the characters allowed in an alias and their replacement. The default is [a-zA-Z0-9_] and '_'.
+    void setNamingPolicy(const Util::NamingPolicy &policy);
+
+    // Return the naming policy
+    const Util::NamingPolicy &namingPolicy() const { return _engine.namingPolicy(); }
+
+    // Return the selection engine. Changes made to it directly can't be undone.
+    const Engine::SelectionEngine &engine() const { return _engine; }
+
+public slots:
+    // Stop the background loading. The current selection is kept.
+    void cancelLoading();
+
+signals:
+    void loadProgress(int percent);
+    void loadFinished(bool success);
 
 private slots:
     void on__fullListCheckBox_clicked();
+    void on__viewComboBox_activated(int index);
     void on__addItemButton_clicked();
     void on__removeItemButton_clicked();
     void on__reset_clicked();
     void on__availableListView_doubleClicked(const QModelIndex &index);
     void on__loadListButton_clicked();
     void on__saveListButton_clicked();
-    void onSelectedListRowsInserted(const QModelIndex &parent, int first, int last);
-    void onSelectedListRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onSelectedListRenameRequested(int row, const QString &alias);
+    void onSelectedListMoveRequested(int first, int count, int destRow);
     void onSelectedViewEditEnd(QWidget *, QAbstractItemDelegate::EndEditHint);
+    void onListFileProgress(int percent);
+    void onListFileLoaded(int status);
+
+private: // Engine::SelectionObserver
+    void availableListReset() override;
+    void availableListChanged() override;
+    void availableViewsChanged() override;
+    void availableIndexesAppended(const std::vector<unsigned int> &index) override;
+    void availableIndexesInserted(const std::vector<unsigned int> &index) override;
+    void availableIndexesRemoved(const std::vector<unsigned int> &index) override;
+    void availableIndexesRenumbered(const std::vector<int> &newIndex) override;
+    void selectedItemsInserted(int first, int last) override;
+    void selectedItemsRemoved(int first, int last) override;
+    void selectedListReset() override;
 
 private:
     // Return true if it's currently showing the full list
-    bool isFullList();
+    bool isFullList() const { return _engine.isFullList(); }
+
+    // Show the full list checkbox once there's a short list, and check it as the engine shows
+    void updateFullListCheckBox();
+
+    // Show the view combo box once there are views, with the current view of the engine
+    void updateViewComboBox();
 
-    // Change between full/short list
+    // Rebuild the available list. The available list only holds the index of unselected items.
+    // Use it when the full list or the tooltip list has been replaced.
     void populateAvailableList();
 
-    // Update selected list after items move
-    void updateSelectedList(const QModelIndexList &selections);
+    // Change between full/short list or follow a new selection with the smallest set of row
+    // insertions and removals. The views keep their scroll position and selection.
+    void updateAvailableList();
+
+    // Show the message label if the names are checked
+    void showNameCheckMessage();
+
+    // Return the row ranges [first, last] of a selection, sorted and merged into contiguous runs
+    static std::vector<std::pair<int,int>> selectionRuns(const QItemSelection &selection);
 
     // Add items to the right listview
-    void addItems(const QModelIndexList &selections);
+    void addItems(const QItemSelection &selection);
 
     // Remove items from the right listview. Put back to left listview
-    void removeItems(const QModelIndexList &selections);
+    void removeItems(const QItemSelection &selection);
+
+    // Move the rows of the right listview (ascending) in front of destRow, keeping their order
+    void reorderItems(const std::vector<int> &fromRows, int destRow);
 
     // Set the selected items to be Pre-populated in the selected view
     void loadSelectedItemsFromLists(const QStringList &sList_raw, const QStringList &sList_alias);
 
-    // Read selected items from a CSV file
-    void readSelectedItemsListFromFile(const QString &filename, QStringList &sList_raw, QStringList &sList_alias);
+    // Set the selected items by their index of the full list
+    void loadSelectedItems(const std::vector<unsigned int> &index, const QStringList &sList_alias);
+
+    // Save the selected items as a binary snapshot
+    void saveSnapshotToFile(const QString &filename);
+
+    // Show the error message of a failed loading
+    void showLoadError(int status);
 
     // Save the selected items to a file file so we can load it again
     void saveSelectedItemsListToFile(const QString &filename);
 
     // Return a reduced stringlist based on index
-    QStringList reducedListByIndex(const QStringList &fList, const std::vector<unsigned int> index);
+    QStringList reducedListByIndex(const Util::Catalog &catalog, const std::vector<unsigned int> index);
 
-    // A helper function looks for the appropriate position when remove an item from selected list
-    unsigned int findNextRowInAvailableList(unsigned int rowNum, std::vector<unsigned int> tempIndex);
+    // A helper function looks for the appropriate position when remove an item from selected list.
+    // Return the row in the available list where the full list index goes back to in O(log N).
+    int findNextRowInAvailableList(unsigned int fullIndex) const;
 
     // Check item name error
-    void checkItemNameError(QStandardItem *item);
-
-    // A helper function for replacing special characters with underscores
-    void makeUnderscoreVar(QString &str);
-
-    // A helper function to handle duplicate item name
-    QString duplicateNameHandler(const QString &str);
-
-    // Itme drop & drop action identifier
-    ActionId currentDragDropAction();
+    void checkItemNameError(int row);
 
     // Display warning message
     void messageBox(const QString &title, QMessageBox::Icon icon = QMessageBox::Warning);    
 
 private: // Vars
     Ui::AddRemoveSelection *ui;
-    QStandardItemModel _availableItemModel;
-    QStandardItemModel _selectedItemModel;
-    QStringList _fullList;
-    QStringList _tooltipList;    
-    std::vector<unsigned int> _selectedListIndex;    
-    std::vector<unsigned int> _shortListIndex;
-    bool _validNameCheck = false;
-    // Variables helps on determine current action
-    bool _itemsDropInSelectedView = false;
-    bool _itemsDropInAvailableView = false;
-    bool _itemsSelectedInAvailableView = false;
-    bool _itemsSelectedInSelectedView = false;
-    unsigned int _numOfMovedItem;
+    // The models read from the engine, so it's declared first
+    Engine::SelectionEngine _engine;
+    AvailableListModel _availableItemModel;
+    SelectedListModel _selectedItemModel;
+    // Undo / redo
+    QUndoStack _undoStack;
+    // Optional journal of the selection, it follows the engine
+    Engine::SelectionJournal _journal;
+    // The selection published for the other threads
+    Engine::SelectionPublisher _publisher;
+    // Loader running in the background, nullptr if none
+    Util::ListFileLoader *_fileLoader = nullptr;
+    // Threads of the loaders which may still be running, including the cancelled ones. They're
+    // waited for when the widget is destroyed.
+    QList<QPointer<QThread>> _loaderThreads;
 
 protected:
     bool eventFilter(QObject *object, QEvent *event) override;
@@ -0,0 +1,367 @@
+#include "AvailableListModel.h"
+#include <algorithm>
+#include <iterator>
+#include <Util/Trace.h>
+
+namespace Widgets
+{
+
+const unsigned int AvailableListModel::FetchSize;
+
+AvailableListModel::AvailableListModel(QObject *parent) : QAbstractListModel(parent) {
+
+}
+
+void AvailableListModel::setCatalog(const Util::Catalog *catalog) {
+    beginResetModel();
+    _catalog = catalog;
+    _rowIndex.clear();
+    endResetModel();
+}
+
+void AvailableListModel::setRowIndex(const std::vector<unsigned int> &rowIndex) {
+    Util::TraceSpan span("AvailableListModel::setRowIndex");
+    span.setItems(qint64(rowIndex.size()));
+    beginResetModel();
+    // Only the first rows are shown, the rest is fetched when the view needs them
+    auto fetchEnd = rowIndex.begin() + std::min<size_t>(rowIndex.size(), FetchSize);
+    _rowIndex.assign(rowIndex.begin(), fetchEnd);
+    _pendingIndex.assign(fetchEnd, rowIndex.end());
+    endResetModel();
+}
+
+void AvailableListModel::updateRowIndex(const std::vector<unsigned int> &rowIndex) {
+    Util::TraceSpan span("AvailableListModel::updateRowIndex");
+    span.setItems(qint64(rowIndex.size()));
+    // The part of the new index which hasn't been fetched stays pending
+    auto fetchEnd = rowIndex.begin() + fetchedCount(rowIndex);
+    _pendingIndex.assign(fetchEnd, rowIndex.end());
+    std::vector<unsigned int> fetchedIndex(rowIndex.begin(), fetchEnd);
+    if (fetchedIndex == _rowIndex) {
+        return;
+    }
+    // Both are sorted, so after the removal the remaining rows are a subsequence of the new
+    // index and the rest can be filled in by insertions.
+    removeRowsNotIn(fetchedIndex);
+    insertRowsFrom(fetchedIndex);
+}
+
+void AvailableListModel::appendRowIndex(const std::vector<unsigned int> &rowIndex) {
+    Util::TraceSpan span("AvailableListModel::appendRowIndex");
+    span.setItems(qint64(rowIndex.size()));
+    for (const unsigned int &idx : rowIndex) {
+        // Keep the order, an index which isn't past the end is dropped
+        if ((_pendingIndex.empty() || idx > _pendingIndex.back()) && (_rowIndex.empty() || idx > _rowIndex.back())) {
+            _pendingIndex.push_back(idx);
+        }
+    }
+    // Fill up the first screen right away, the views fetch the rest as they scroll
+    if (_rowIndex.size() < FetchSize) {
+        fetchRows(FetchSize - unsigned(_rowIndex.size()));
+    }
+}
+
+unsigned int AvailableListModel::fetchedCount(const std::vector<unsigned int> &rowIndex) const {
+    // As many rows as are fetched now, at least a first screen, so switching to a larger view
+    // doesn't insert all of its rows at once
+    unsigned int count = std::min(std::max(size(), FetchSize), unsigned(rowIndex.size()));
+    if (!_pendingIndex.empty()) {
+        count = std::min(count, unsigned(std::lower_bound(rowIndex.begin(), rowIndex.end(), _pendingIndex.front()) - rowIndex.begin()));
+    }
+    return count;
+}
+
+void AvailableListModel::fetchRows(unsigned int count) {
+    count = std::min(count, unsigned(_pendingIndex.size()));
+    if (count == 0) {
+        return;
+    }
+    Util::TraceSpan span("AvailableListModel::fetchRows");
+    span.setItems(count);
+    const int nRow = int(_rowIndex.size());
+    beginInsertRows(QModelIndex(), nRow, nRow + int(count) - 1);
+    _rowIndex.insert(_rowIndex.end(), _pendingIndex.begin(), _pendingIndex.begin() + count);
+    _pendingIndex.erase(_pendingIndex.begin(), _pendingIndex.begin() + count);
+    endInsertRows();
+}
+
+/*
+ * The removal walks the rows from the top with two cursors. Rows which are kept are copied
+ * down to _gapBegin, and a run of rows which are not in the new index is dropped by moving
+ * _gapEnd over it. The rows between the signals are always _rowIndex[0, _gapBegin) followed
+ * by _rowIndex[_gapEnd, end), so each run costs one signal and no shifting of the vector.
+*/
+void AvailableListModel::removeRowsNotIn(const std::vector<unsigned int> &rowIndex) {
+    const unsigned int nRow = unsigned(_rowIndex.size());
+    unsigned int nIdx = 0;
+    _gapBegin = 0;
+    _gapEnd = 0;
+    while (_gapEnd < nRow) {
+        // Find the end of the run of rows which are not in the new index
+        unsigned int runEnd = _gapEnd;
+        while (runEnd < nRow) {
+            while (nIdx < rowIndex.size() && rowIndex.at(nIdx) < _rowIndex.at(runEnd)) {
+                nIdx++;
+            }
+            if (nIdx < rowIndex.size() && rowIndex.at(nIdx) == _rowIndex.at(runEnd)) {
+                break;
+            }
+            runEnd++;
+        }
+        if (runEnd > _gapEnd) {
+            beginRemoveRows(QModelIndex(), int(_gapBegin), int(_gapBegin + runEnd - _gapEnd - 1));
+            _gapEnd = runEnd;
+            endRemoveRows();
+        }
+        // Keep the row
+        if (_gapEnd < nRow) {
+            _rowIndex[_gapBegin++] = _rowIndex[_gapEnd++];
+            nIdx++;
+        }
+    }
+    _rowIndex.resize(_gapBegin);
+    _gapBegin = 0;
+    _gapEnd = 0;
+}
+
+/*
+ * The insertion first moves the remaining rows to the end of a vector which has the final
+ * size, so the gap sits in front of them. Walking the new index, rows which already exist
+ * are copied down to _gapBegin, and each run of new rows is written into the gap with one
+ * signal. The gap is exactly as large as the rows still to be inserted.
+*/
+void AvailableListModel::insertRowsFrom(const std::vector<unsigned int> &rowIndex) {
+    const unsigned int nOld = unsigned(_rowIndex.size());
+    const unsigned int nNew = unsigned(rowIndex.size());
+    if (nOld == nNew) {
+        return;
+    }
+    _rowIndex.resize(nNew);
+    std::copy_backward(_rowIndex.begin(), _rowIndex.begin() + nOld, _rowIndex.end());
+    _gapBegin = 0;
+    _gapEnd = nNew - nOld;
+    unsigned int nIdx = 0;
+    while (nIdx < nNew) {
+        if (_gapEnd < nNew && _rowIndex.at(_gapEnd) == rowIndex.at(nIdx)) {
+            // Keep the row
+            _rowIndex[_gapBegin++] = _rowIndex[_gapEnd++];
+            nIdx++;
+            continue;
+        }
+        // Find the end of the run of rows to be inserted
+        unsigned int runEnd = nIdx;
+        while (runEnd < nNew && (_gapEnd == nNew || rowIndex.at(runEnd) != _rowIndex.at(_gapEnd))) {
+            runEnd++;
+        }
+        beginInsertRows(QModelIndex(), int(_gapBegin), int(_gapBegin + runEnd - nIdx - 1));
+        std::copy(rowIndex.begin() + nIdx, rowIndex.begin() + runEnd, _rowIndex.begin() + _gapBegin);
+        _gapBegin += runEnd - nIdx;
+        endInsertRows();
+        nIdx = runEnd;
+    }
+    _gapBegin = 0;
+    _gapEnd = 0;
+}
+
+int AvailableListModel::rowOfIndex(unsigned int fullIndex) const {
+    return int(std::lower_bound(_rowIndex.begin(), _rowIndex.end(), fullIndex) - _rowIndex.begin());
+}
+
+/*
+ * Same as insertRowsFrom(), the current rows are moved to the end first and the gap in front
+ * of them is filled run by run. The rows in front of each run are copied down, the rest of
+ * the rows are already in place once the last run fills the gap.
+*/
+void AvailableListModel::insertIndexes(const std::vector<int> &rows, const std::vector<unsigned int> &fullIndexes) {
+    Util::TraceSpan span("AvailableListModel::insertIndexes");
+    span.setItems(qint64(fullIndexes.size()));
+    const unsigned int nOld = unsigned(_rowIndex.size());
+    unsigned int nIns = unsigned(std::min(rows.size(), fullIndexes.size()));
+    if (!_pendingIndex.empty()) {
+        // The indexes past the fetched rows go back to the pending indexes, merged in one pass
+        const unsigned int nFetched = unsigned(std::lower_bound(fullIndexes.begin(), fullIndexes.begin() + nIns,
+                                                                _pendingIndex.front()) - fullIndexes.begin());
+        if (nFetched < nIns) {
+            std::deque<unsigned int> pendingIndex;
+            std::set_union(_pendingIndex.begin(), _pendingIndex.end(), fullIndexes.begin() + nFetched,
+                           fullIndexes.begin() + nIns, std::back_inserter(pendingIndex));
+            _pendingIndex.swap(pendingIndex);
+        }
+        nIns = nFetched;
+    }
+    if (nIns == 0) {
+        return;
+    }
+    _rowIndex.resize(nOld + nIns);
+    std::copy_backward(_rowIndex.begin(), _rowIndex.begin() + nOld, _rowIndex.end());
+    _gapBegin = 0;
+    _gapEnd = nIns;
+    unsigned int nIdx = 0;
+    while (nIdx < nIns) {
+        // Keep the rows in front of the run. The current row r is at _rowIndex[nIns + r].
+        const unsigned int row = unsigned(rows.at(nIdx));
+        while (_gapEnd - nIns < row && _gapEnd < nOld + nIns) {
+            _rowIndex[_gapBegin++] = _rowIndex[_gapEnd++];
+        }
+        unsigned int runEnd = nIdx;
+        while (runEnd < nIns && unsigned(rows.at(runEnd)) == row) {
+            runEnd++;
+        }
+        beginInsertRows(QModelIndex(), int(_gapBegin), int(_gapBegin + runEnd - nIdx - 1));
+        std::copy(fullIndexes.begin() + nIdx, fullIndexes.begin() + runEnd, _rowIndex.begin() + _gapBegin);
+        _gapBegin += runEnd - nIdx;
+        endInsertRows();
+        nIdx = runEnd;
+    }
+    _gapBegin = 0;
+    _gapEnd = 0;
+}
+
+void AvailableListModel::removeRowRuns(const std::vector<std::pair<int,int>> &runs) {
+    const unsigned int nRow = unsigned(_rowIndex.size());
+    _gapBegin = 0;
+    _gapEnd = 0;
+    for (const auto &run : runs) {
+        if (run.first < 0 || unsigned(run.first) < _gapEnd || run.second < run.first || unsigned(run.second) >= nRow) {
+            continue;
+        }
+        // Keep the rows in front of the run
+        while (_gapEnd < unsigned(run.first)) {
+            _rowIndex[_gapBegin++] = _rowIndex[_gapEnd++];
+        }
+        beginRemoveRows(QModelIndex(), int(_gapBegin), int(_gapBegin) + run.second - run.first);
+        _gapEnd = unsigned(run.second) + 1;
+        endRemoveRows();
+    }
+    // Close the gap
+    std::copy(_rowIndex.begin() + _gapEnd, _rowIndex.end(), _rowIndex.begin() + _gapBegin);
+    _rowIndex.resize(nRow - (_gapEnd - _gapBegin));
+    _gapBegin = 0;
+    _gapEnd = 0;
+}
+
+void AvailableListModel::removeIndexes(const std::vector<unsigned int> &fullIndexes) {
+    Util::TraceSpan span("AvailableListModel::removeIndexes");
+    span.setItems(qint64(fullIndexes.size()));
+    std::vector<std::pair<int,int>> runs;
+    std::vector<unsigned int> pendingRemoved;
+    for (const unsigned int &idx : fullIndexes) {
+        int row = rowOfIndex(idx);
+        if (row < int(_rowIndex.size()) && _rowIndex.at(unsigned(row)) == idx) {
+            if (!runs.empty() && runs.back().second + 1 == row) {
+                runs.back().second = row;
+            }
+            else {
+                runs.push_back(std::make_pair(row, row));
+            }
+        }
+        else if (!_pendingIndex.empty() && idx >= _pendingIndex.front()) {
+            pendingRemoved.push_back(idx);
+        }
+    }
+    removeRowRuns(runs);
+    // One pass over the pending indexes, however many of them are removed
+    if (!pendingRemoved.empty()) {
+        std::deque<unsigned int> pendingIndex;
+        std::set_difference(_pendingIndex.begin(), _pendingIndex.end(), pendingRemoved.begin(), pendingRemoved.end(),
+                            std::back_inserter(pendingIndex));
+        _pendingIndex.swap(pendingIndex);
+    }
+}
+
+void AvailableListModel::renumberIndexes(const std::vector<int> &newIndex) {
+    Util::TraceSpan span("AvailableListModel::renumberIndexes");
+    span.setItems(qint64(_rowIndex.size() + _pendingIndex.size()));
+    // The order is the same, so the rows stay sorted and only their numbers change
+    for (unsigned int &idx : _rowIndex) {
+        idx = unsigned(newIndex.at(idx));
+    }
+    for (unsigned int &idx : _pendingIndex) {
+        idx = unsigned(newIndex.at(idx));
+    }
+    // The names are the same, the tooltips might not be
+    if (!_rowIndex.empty()) {
+        emit dataChanged(index(0), index(int(_rowIndex.size()) - 1), QVector<int>() << Qt::ToolTipRole << FullListIndexRole);
+    }
+}
+
+void AvailableListModel::clear() {
+    beginResetModel();
+    _rowIndex.clear();
+    _pendingIndex.clear();
+    endResetModel();
+}
+
+int AvailableListModel::rowCount(const QModelIndex &parent) const {
+    return (parent.isValid()) ? 0 : int(size());
+}
+
+QVariant AvailableListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= int(size()) || !_catalog) {
+        return QVariant();
+    }
+    int fullIndex = int(indexAt(unsigned(index.row())));
+    if (fullIndex >= _catalog->size()) {
+        return QVariant();
+    }
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return _catalog->name(fullIndex);
+    case FullListIndexRole:
+        return unsigned(fullIndex);
+    case Qt::ToolTipRole:
+        // Looked up in the tooltip dictionary only when the view asks for it
+        if (_catalog->hasTooltips()) {
+            return _catalog->tooltip(fullIndex);
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+bool AvailableListModel::canFetchMore(const QModelIndex &parent) const {
+    return !parent.isValid() && !_pendingIndex.empty();
+}
+
+void AvailableListModel::fetchMore(const QModelIndex &parent) {
+    if (!parent.isValid()) {
+        fetchRows(FetchSize);
+    }
+}
+
+QMap<int, QVariant> AvailableListModel::itemData(const QModelIndex &index) const {
+    // The default implementation skips the user roles, but the full list index must travel
+    // with the dragged items.
+    QMap<int, QVariant> roles = QAbstractListModel::itemData(index);
+    QVariant fullIndex = data(index, FullListIndexRole);
+    if (fullIndex.isValid()) {
+        roles.insert(FullListIndexRole, fullIndex);
+    }
+    return roles;
+}
+
+Qt::ItemFlags AvailableListModel::flags(const QModelIndex &index) const {
+    if (!index.isValid()) {
+        return Qt::ItemIsDropEnabled;
+    }
+    // Items are not drop enabled so that dropping on an item never overwrites it.
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled;
+}
+
+bool AvailableListModel::removeRows(int row, int count, const QModelIndex &parent) {
+    if (parent.isValid() || row < 0 || count < 1 || (row + count) > int(_rowIndex.size())) {
+        return false;
+    }
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    _rowIndex.erase(_rowIndex.begin() + row, _rowIndex.begin() + row + count);
+    endRemoveRows();
+    return true;
+}
+
+Qt::DropActions AvailableListModel::supportedDropActions() const {
+    return Qt::CopyAction | Qt::MoveAction;
+}
+
+}
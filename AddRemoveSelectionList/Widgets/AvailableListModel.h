@@ -0,0 +1,121 @@
+#ifndef AVAILABLELISTMODEL_H
+#define AVAILABLELISTMODEL_H
+
+#include <vector>
+#include <deque>
+#include <utility>
+#include <QAbstractListModel>
+#include <QStringList>
+#include "ItemDataRole.h"
+#include <Util/Catalog.h>
+
+namespace Widgets
+{
+
+/*
+ * AvailableListModel is a light weight model for the available (left) list view. Instead
+ * of keeping a QStandardItem for every entry, the model only stores the full list index of
+ * each row and serves the text and tooltip directly from the catalog owned by the selection
+ * engine. The row index is always kept in the full list order, which
+ * makes looking up the row of a full list index a binary search. The full list index is
+ * also available through the FullListIndexRole.
+ * Rows are fetched on demand. Only the first FetchSize rows are shown at first, the rest
+ * of the index is pending and is brought in by fetchMore() when the view scrolls to the
+ * bottom. Every pending index is larger than the index of any row, so the rows are always a
+ * prefix of the available list and the full list can keep growing at its end.
+*/
+class AvailableListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit AvailableListModel(QObject *parent = nullptr);
+    ~AvailableListModel() override { ; }
+
+    // Set the catalog that the model reads from. It must outlive the model.
+    void setCatalog(const Util::Catalog *catalog);
+
+    // Number of rows brought in at a time
+    static const unsigned int FetchSize = 1024;
+
+    // Replace all rows with a new index of the full list (must be sorted)
+    void setRowIndex(const std::vector<unsigned int> &rowIndex);
+
+    // Bring the rows up to date with a new index of the full list (must be sorted). Only the
+    // rows that differ are removed or inserted, each contiguous run with a single signal, so
+    // the views keep their scroll position and selection. The new index only fills as many
+    // rows as are fetched now (at least FetchSize), the rest is pending.
+    void updateRowIndex(const std::vector<unsigned int> &rowIndex);
+
+    // Append indexes (must be sorted) past the end of the available list, e.g. when the full list
+    // grows. They are pending until fetched, except to fill up the first FetchSize rows.
+    void appendRowIndex(const std::vector<unsigned int> &rowIndex);
+
+    // Return the index of the full list at the row
+    unsigned int fullListIndex(int row) const { return indexAt(unsigned(row)); }
+
+    // Return the row of a full list index. If the index is not in the model, return the row
+    // where it should be inserted.
+    int rowOfIndex(unsigned int fullIndex) const;
+
+    // Insert full list indexes. fullIndexes[i] is inserted in front of the current row rows[i],
+    // and both must be in ascending order. Indexes sharing the same row are inserted as one run.
+    // Indexes past the fetched rows are put back to the pending indexes instead.
+    void insertIndexes(const std::vector<int> &rows, const std::vector<unsigned int> &fullIndexes);
+
+    // Remove runs of rows. Each run is a [first, last] pair, the runs must be in ascending order
+    // and must not overlap.
+    void removeRowRuns(const std::vector<std::pair<int,int>> &runs);
+
+    // Remove full list indexes (must be sorted), including the pending ones. Each run of
+    // contiguous rows is removed with a single signal.
+    void removeIndexes(const std::vector<unsigned int> &fullIndexes);
+
+    // Give the rows new full list indexes after the full list was reloaded, newIndex[old]. The
+    // order must be the same and every index must be kept.
+    void renumberIndexes(const std::vector<int> &newIndex);
+
+    // Remove all rows, including the pending ones
+    void clear();
+
+public: // QAbstractListModel
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    QMap<int, QVariant> itemData(const QModelIndex &index) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    Qt::DropActions supportedDropActions() const override;
+
+private:
+    // Return the full list index of a row, skipping the gap
+    unsigned int indexAt(unsigned int row) const { return _rowIndex[(row < _gapBegin) ? row : row + (_gapEnd - _gapBegin)]; }
+    // Number of rows, excluding the gap
+    unsigned int size() const { return unsigned(_rowIndex.size()) - (_gapEnd - _gapBegin); }
+    // Remove the rows which are not in the new index
+    void removeRowsNotIn(const std::vector<unsigned int> &rowIndex);
+    // Insert the rows of the new index which are not in the model yet
+    void insertRowsFrom(const std::vector<unsigned int> &rowIndex);
+    // Return the number of entries of a sorted index which belong to the rows, the rest are
+    // pending. It's at most the number of rows, or FetchSize.
+    unsigned int fetchedCount(const std::vector<unsigned int> &rowIndex) const;
+    // Move up to count pending indexes to the end of the rows
+    void fetchRows(unsigned int count);
+
+private:
+    const Util::Catalog *_catalog = nullptr;
+    // The full list index of each row
+    std::vector<unsigned int> _rowIndex;
+    // While updateRowIndex() is in progress, _rowIndex[_gapBegin, _gapEnd) is a gap which is
+    // not part of the rows. It lets the update work in place while each signal still sees a
+    // consistent model. The gap is empty otherwise.
+    unsigned int _gapBegin = 0;
+    unsigned int _gapEnd = 0;
+    // Sorted full list indexes which are available but not fetched yet
+    std::deque<unsigned int> _pendingIndex;
+};
+
+}
+
+#endif // AVAILABLELISTMODEL_H
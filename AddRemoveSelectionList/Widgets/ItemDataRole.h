@@ -0,0 +1,22 @@
+#ifndef ITEMDATAROLE_H
+#define ITEMDATAROLE_H
+
+#include <Qt>
+
+namespace Widgets
+{
+
+/*
+ * Custom item data roles used by the items of the available and the selected list. Every
+ * item carries the index of its entry in the full list, so an item can be identified
+ * without comparing the text, which is not unique and can be renamed in the selected list.
+*/
+enum ItemDataRole {
+    FullListIndexRole = Qt::UserRole + 1,
+    // The alias of a selected item, which is also its text
+    AliasRole = Qt::UserRole + 2
+};
+
+}
+
+#endif // ITEMDATAROLE_H
@@ -0,0 +1,121 @@
+#include "SelectedListModel.h"
+
+namespace Widgets
+{
+
+SelectedListModel::SelectedListModel(Engine::SelectionEngine *engine, QObject *parent) :
+    QAbstractListModel(parent), _engine(engine) {
+    _engine->addObserver(this);
+}
+
+SelectedListModel::~SelectedListModel() {
+    _engine->removeObserver(this);
+}
+
+int SelectedListModel::rowCount(const QModelIndex &parent) const {
+    return (parent.isValid()) ? 0 : int(_engine->selectedCount());
+}
+
+QVariant SelectedListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= int(_engine->selectedCount())) {
+        return QVariant();
+    }
+    const unsigned int fullIndex = fullListIndex(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+    case AliasRole:
+        return _engine->alias(index.row());
+    case FullListIndexRole:
+        return fullIndex;
+    case Qt::ToolTipRole:
+        // Tooltip is available on when the item name might be changed
+        if (_engine->validNameCheck() && fullIndex < unsigned(_engine->catalog().size())) {
+            return _engine->catalog().name(int(fullIndex));
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+bool SelectedListModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+    if (!index.isValid() || role != Qt::EditRole || index.row() >= int(_engine->selectedCount())) {
+        return false;
+    }
+    QString alias = value.toString();
+    if (alias != _engine->alias(index.row())) {
+        emit renameRequested(index.row(), alias);
+    }
+    return true;
+}
+
+QMap<int, QVariant> SelectedListModel::itemData(const QModelIndex &index) const {
+    // The full list index travels with the dragged items, same as the available list
+    QMap<int, QVariant> roles = QAbstractListModel::itemData(index);
+    QVariant fullIndex = data(index, FullListIndexRole);
+    if (fullIndex.isValid()) {
+        roles.insert(FullListIndexRole, fullIndex);
+    }
+    return roles;
+}
+
+Qt::ItemFlags SelectedListModel::flags(const QModelIndex &index) const {
+    if (!index.isValid()) {
+        return Qt::ItemIsDropEnabled;
+    }
+    // Items are not drop enabled so that dropping on an item never overwrites it.
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsEditable | Qt::ItemIsDragEnabled;
+}
+
+Qt::DropActions SelectedListModel::supportedDropActions() const {
+    return Qt::CopyAction | Qt::MoveAction;
+}
+
+bool SelectedListModel::moveRows(const QModelIndex &sourceParent, int sourceRow, int count, const QModelIndex &destinationParent, int destinationChild) {
+    if (sourceParent.isValid() || destinationParent.isValid() || count <= 0 || sourceRow < 0 ||
+            sourceRow + count > rowCount() || destinationChild < 0 || destinationChild > rowCount()) {
+        return false;
+    }
+    emit moveRequested(sourceRow, count, destinationChild);
+    return true;
+}
+
+void SelectedListModel::selectedItemsAboutToBeInserted(int first, int last) {
+    beginInsertRows(QModelIndex(), first, last);
+}
+
+void SelectedListModel::selectedItemsInserted(int, int) {
+    endInsertRows();
+}
+
+void SelectedListModel::selectedItemsAboutToBeRemoved(int first, int last) {
+    beginRemoveRows(QModelIndex(), first, last);
+}
+
+void SelectedListModel::selectedItemsRemoved(int, int) {
+    endRemoveRows();
+}
+
+void SelectedListModel::selectedItemsAboutToBeMoved(int first, int last, int destRow) {
+    beginMoveRows(QModelIndex(), first, last, QModelIndex(), destRow);
+}
+
+void SelectedListModel::selectedItemsMoved(int, int, int) {
+    endMoveRows();
+}
+
+void SelectedListModel::selectedItemRenamed(int row) {
+    QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, QVector<int>() << Qt::DisplayRole << Qt::EditRole << AliasRole);
+}
+
+void SelectedListModel::selectedListAboutToBeReset() {
+    beginResetModel();
+}
+
+void SelectedListModel::selectedListReset() {
+    endResetModel();
+}
+
+}
@@ -0,0 +1,64 @@
+#ifndef SELECTEDLISTMODEL_H
+#define SELECTEDLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QStringList>
+#include "ItemDataRole.h"
+#include <Engine/SelectionEngine.h>
+
+namespace Widgets
+{
+
+/*
+ * SelectedListModel is the model of the selected (right) list view. It holds no item of its
+ * own: the rows are the selected items of a SelectionEngine, and the model forwards the
+ * changes of the engine as its own row signals. An edit doesn't change the engine directly,
+ * it's reported by renameRequested() so that AddRemoveSelection can apply it through the
+ * undo stack, and so is a move of rows by moveRows(), which is reported by moveRequested().
+ * Drops are handled by AddRemoveSelection as well, the model only accepts them.
+*/
+class SelectedListModel : public QAbstractListModel, private Engine::SelectionObserver
+{
+    Q_OBJECT
+
+public:
+    // The engine must outlive the model
+    explicit SelectedListModel(Engine::SelectionEngine *engine, QObject *parent = nullptr);
+    ~SelectedListModel() override;
+
+    // Return the index of the full list at the row
+    unsigned int fullListIndex(int row) const { return _engine->selectedIndexAt(row); }
+
+signals:
+    // The alias of the row was edited
+    void renameRequested(int row, const QString &alias);
+    // The rows [first, first + count - 1] were moved in front of destRow
+    void moveRequested(int first, int count, int destRow);
+
+public: // QAbstractListModel
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QMap<int, QVariant> itemData(const QModelIndex &index) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    Qt::DropActions supportedDropActions() const override;
+    bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count, const QModelIndex &destinationParent, int destinationChild) override;
+
+private: // Engine::SelectionObserver
+    void selectedItemsAboutToBeInserted(int first, int last) override;
+    void selectedItemsInserted(int first, int last) override;
+    void selectedItemsAboutToBeRemoved(int first, int last) override;
+    void selectedItemsRemoved(int first, int last) override;
+    void selectedItemsAboutToBeMoved(int first, int last, int destRow) override;
+    void selectedItemsMoved(int first, int last, int destRow) override;
+    void selectedItemRenamed(int row) override;
+    void selectedListAboutToBeReset() override;
+    void selectedListReset() override;
+
+private:
+    Engine::SelectionEngine *_engine;
+};
+
+}
+
+#endif // SELECTEDLISTMODEL_H
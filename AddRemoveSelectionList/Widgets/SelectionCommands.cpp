@@ -0,0 +1,109 @@
+#include "SelectionCommands.h"
+
+namespace Widgets
+{
+
+IndexRanges::IndexRanges(const std::vector<unsigned int> &index) : _size(unsigned(index.size())) {
+    for (const unsigned int &idx : index) {
+        if (!_ranges.empty() && _ranges.back().second + 1 == idx) {
+            _ranges.back().second = idx;
+        }
+        else {
+            _ranges.push_back(std::make_pair(idx, idx));
+        }
+    }
+}
+
+std::vector<unsigned int> IndexRanges::toVector() const {
+    std::vector<unsigned int> index;
+    index.reserve(_size);
+    for (const auto &range : _ranges) {
+        for (unsigned int idx = range.first ; idx <= range.second ; ++idx) {
+            index.push_back(idx);
+        }
+    }
+    return index;
+}
+
+AddItemsCommand::AddItemsCommand(Engine::SelectionEngine *engine, int row, const std::vector<unsigned int> &index) :
+    _engine(engine), _row(row), _index(index) {
+    setText(QString("Add %1 item(s)").arg(index.size()));
+}
+
+void AddItemsCommand::undo() {
+    _engine->takeItems(std::vector<std::pair<int,int>>(1, std::make_pair(_row, _row + int(_index.size()) - 1)));
+}
+
+void AddItemsCommand::redo() {
+    std::vector<unsigned int> index = _index.toVector();
+    _engine->insertItems(_row, index, _engine->defaultAliases(index));
+}
+
+RemoveItemsCommand::RemoveItemsCommand(Engine::SelectionEngine *engine, const std::vector<std::pair<int,int>> &runs) :
+    _engine(engine), _runs(runs) {
+    unsigned int nItem = 0;
+    for (const auto &run : runs) {
+        RemovedRun removedRun;
+        removedRun.row = run.first;
+        std::vector<unsigned int> index;
+        for (int row = run.first ; row <= run.second ; ++row) {
+            index.push_back(engine->selectedIndexAt(row));
+        }
+        removedRun.aliasList.reserve(int(index.size()));
+        for (int row = run.first ; row <= run.second ; ++row) {
+            removedRun.aliasList << engine->alias(row);
+        }
+        removedRun.index = IndexRanges(index);
+        nItem += unsigned(index.size());
+        _removedRuns.push_back(removedRun);
+    }
+    setText(QString("Remove %1 item(s)").arg(nItem));
+}
+
+void RemoveItemsCommand::undo() {
+    // The runs are put back from the top, so each run goes back to its original row
+    for (const RemovedRun &removedRun : _removedRuns) {
+        _engine->insertItems(removedRun.row, removedRun.index.toVector(), removedRun.aliasList);
+    }
+}
+
+void RemoveItemsCommand::redo() {
+    _engine->takeItems(_runs);
+}
+
+ReorderItemsCommand::ReorderItemsCommand(Engine::SelectionEngine *engine, const std::vector<int> &fromRows, const std::vector<int> &toRows) :
+    _engine(engine), _fromRows(fromRows), _toRows(toRows) {
+    setText(QString("Move %1 item(s)").arg(fromRows.size()));
+}
+
+void ReorderItemsCommand::undo() {
+    _engine->moveItems(_toRows, _fromRows);
+}
+
+void ReorderItemsCommand::redo() {
+    _engine->moveItems(_fromRows, _toRows);
+}
+
+RenameItemCommand::RenameItemCommand(Engine::SelectionEngine *engine, int row, const QString &oldAlias, const QString &newAlias) :
+    _engine(engine), _row(row), _oldAlias(oldAlias), _newAlias(newAlias) {
+    setText(QString("Rename %1").arg(oldAlias));
+}
+
+void RenameItemCommand::undo() {
+    _engine->renameItem(_row, _oldAlias);
+}
+
+void RenameItemCommand::redo() {
+    _engine->renameItem(_row, _newAlias);
+}
+
+bool RenameItemCommand::mergeWith(const QUndoCommand *command) {
+    const RenameItemCommand *rename = static_cast<const RenameItemCommand*>(command);
+    if (rename->_row != _row || rename->_oldAlias != _newAlias) {
+        return false;
+    }
+    _newAlias = rename->_newAlias;
+    return true;
+}
+
+}
@@ -0,0 +1,113 @@
+#ifndef SELECTIONCOMMANDS_H
+#define SELECTIONCOMMANDS_H
+
+#include <vector>
+#include <utility>
+#include <QUndoCommand>
+#include <QStringList>
+#include <Engine/SelectionEngine.h>
+
+namespace Widgets
+{
+
+/*
+ * IndexRanges keeps a list of full list indexes as runs of consecutive indexes. Items are
+ * usually added and removed in blocks of the full list, so a block of any size costs one
+ * range.
+*/
+class IndexRanges {
+
+public:
+    IndexRanges() { ; }
+    explicit IndexRanges(const std::vector<unsigned int> &index);
+    // Return the indexes
+    std::vector<unsigned int> toVector() const;
+    // Return the number of indexes
+    unsigned int size() const { return _size; }
+
+private:
+    // Runs of consecutive indexes as [first, last]
+    std::vector<std::pair<unsigned int, unsigned int>> _ranges;
+    unsigned int _size = 0;
+};
+
+/*
+ * The undo commands of AddRemoveSelection. Each command only keeps what changed: the full
+ * list indexes as ranges, the rows they were at, and the aliases of the removed items. Undo
+ * and redo apply the change to the selection engine, which updates the
+ * views with one model update per contiguous block. Every action is done by the first redo
+ * when the command is pushed.
+*/
+
+// Items appended at the end of the selected list
+class AddItemsCommand : public QUndoCommand {
+
+public:
+    AddItemsCommand(Engine::SelectionEngine *engine, int row, const std::vector<unsigned int> &index);
+    void undo() override;
+    void redo() override;
+
+private:
+    Engine::SelectionEngine *_engine;
+    int _row;
+    IndexRanges _index;
+};
+
+// Runs of rows removed from the selected list
+class RemoveItemsCommand : public QUndoCommand {
+
+public:
+    // The removed items are read from the engine, so it must be created before the removal
+    RemoveItemsCommand(Engine::SelectionEngine *engine, const std::vector<std::pair<int,int>> &runs);
+    void undo() override;
+    void redo() override;
+
+private:
+    struct RemovedRun {
+        int row;
+        IndexRanges index;
+        // The aliases as they were when the items were removed. The default aliases depend on
+        // the naming policy, which may change before the undo.
+        QStringList aliasList;
+    };
+
+private:
+    Engine::SelectionEngine *_engine;
+    std::vector<std::pair<int,int>> _runs;
+    std::vector<RemovedRun> _removedRuns;
+};
+
+// Items moved by drag/drop or moveRows(). fromRows and toRows are the rows before and after the move (both ascending).
+class ReorderItemsCommand : public QUndoCommand {
+
+public:
+    ReorderItemsCommand(Engine::SelectionEngine *engine, const std::vector<int> &fromRows, const std::vector<int> &toRows);
+    void undo() override;
+    void redo() override;
+
+private:
+    Engine::SelectionEngine *_engine;
+    std::vector<int> _fromRows;
+    std::vector<int> _toRows;
+};
+
+// Rename of an item. Consecutive renames of the same row are merged.
+class RenameItemCommand : public QUndoCommand {
+
+public:
+    RenameItemCommand(Engine::SelectionEngine *engine, int row, const QString &oldAlias, const QString &newAlias);
+    void undo() override;
+    void redo() override;
+    int id() const override { return 1; }
+    bool mergeWith(const QUndoCommand *command) override;
+
+private:
+    Engine::SelectionEngine *_engine;
+    int _row;
+    QString _oldAlias;
+    QString _newAlias;
+};
+
+}
+
+#endif // SELECTIONCOMMANDS_H